@@ -99,6 +99,23 @@ struct BoolOption : Option
 
 };
 
+struct StringOption : Option
+{
+
+  typedef std::string value_t;
+
+  StringOption (const std::string& desc, const std::string& key, const value_t& default_value) : Option (desc, key), value (default_value) { }
+
+  operator value_t () { return value; }
+
+  virtual void parse (int argc, char** argv) { pcl::console::parse (argc, argv, key.c_str (), value); }
+
+  virtual std::vector<ValueInfo> getValueInfo () { return { std::make_pair (description, value.empty () ? "NONE" : value) }; }
+
+  value_t value;
+
+};
+
 struct EnumOption : Option
 {
 
@@ -179,6 +196,18 @@ public:
     printer::endSection ();
   }
 
+  /** Get a string that lists the keys and values of all options. Two
+    * factories produce the same objects if their signatures are equal. */
+  virtual const std::string
+  getSignature ()
+  {
+    std::stringstream signature;
+    for (const auto& option : options_)
+      for (const auto& value : option->getValueInfo ())
+        signature << option->getKey () << "=" << value.second << ";";
+    return signature.str ();
+  }
+
 protected:
 
   inline void
@@ -3,7 +3,12 @@
 
 #include "factory.h"
 #include "graph/graph_builder.h"
+#include "graph/approximate_grid_search.h"
+#include "graph/cell_list_graph_builder.h"
+#include "graph/adaptive_voxel_grid_graph_builder.h"
 #include "graph/nearest_neighbors_graph_builder.h"
+#include "graph/organized_graph_builder.h"
+#include "graph/supervoxel_graph_builder.h"
 #include "graph/voxel_grid_graph_builder.h"
 
 namespace factory
@@ -19,19 +24,56 @@ public:
 
   GraphBuilderFactory ()
   : Factory ("Graph Builder")
-  , builder_ ("builder type", "--builder", { { "vg",  "VOXEL GRID"              }
-                                           , { "nnk", "NEAREST NEIGHBORS KNN"   }
-                                           , { "nnr", "NEAREST NEIGHBORS RADIUS"} })
+  , builder_ ("builder type", "--builder", { { "vg",          "VOXEL GRID"                        }
+                                           , { "vg-adaptive", "ADAPTIVE VOXEL GRID"               }
+                                           , { "nnk",         "NEAREST NEIGHBORS KNN"             }
+                                           , { "nnk-approx",  "APPROXIMATE NEAREST NEIGHBORS KNN" }
+                                           , { "nnr",         "NEAREST NEIGHBORS RADIUS"          }
+                                           , { "nnr-grid",    "NEAREST NEIGHBORS RADIUS GRID"     }
+                                           , { "org",         "ORGANIZED"                         }
+                                           , { "sv",          "SUPERVOXELS"                       } })
   , voxel_resolution_ ("voxel resolution", "-v", 0.006f)
+  , vertex_budget_ ("vertex budget (0 = no limit)", "--budget", 0)
+  , voxelization_ ("voxelization method", "--voxelization", { { "sort",   "SORT"   }
+                                                           , { "octree", "OCTREE" } })
+  , num_levels_ ("number of octree levels", "--levels", 4)
+  , planarity_threshold_ ("planarity threshold", "--planarity", 0.01f)
+  , color_threshold_ ("color deviation threshold", "--color-deviation", 8.0f)
+  , seed_resolution_ ("supervoxel seed resolution", "--seed-resolution", 0.03f)
+  , color_importance_ ("supervoxel color importance", "--color-importance", 0.2f)
+  , spatial_importance_ ("supervoxel spatial importance", "--spatial-importance", 0.4f)
+  , normal_importance_ ("supervoxel normal importance", "--normal-importance", 1.0f)
   , number_of_neighbors_ ("number of neighbors", "--nn", 14)
   , radius_ ("sphere radius", "--radius", 0.006f)
+  , rings_ ("approximate search rings", "--rings", 1)
   , no_transform_ ("no transform", "-nt")
+  , connectivity_ ("pixel connectivity", "--connectivity", { { "8", "8-NEIGHBORHOOD" }
+                                                          , { "4", "4-NEIGHBORHOOD" } })
+  , depth_threshold_ ("depth discontinuity threshold", "--depth-threshold", 0.05f)
+  , bin_size_ ("pixel bin size", "--bin", 1)
+  , ordering_ ("vertex ordering", "--ordering", { { "none",   "NONE"                  }
+                                               , { "morton", "MORTON CURVE"          }
+                                               , { "rcm",    "REVERSE CUTHILL-MCKEE" } })
   {
     add (&builder_);
     add (&voxel_resolution_);
+    add (&vertex_budget_);
+    add (&voxelization_);
+    add (&num_levels_);
+    add (&planarity_threshold_);
+    add (&color_threshold_);
+    add (&seed_resolution_);
+    add (&color_importance_);
+    add (&spatial_importance_);
+    add (&normal_importance_);
     add (&number_of_neighbors_);
     add (&radius_);
+    add (&rings_);
     add (&no_transform_);
+    add (&connectivity_);
+    add (&depth_threshold_);
+    add (&bin_size_);
+    add (&ordering_);
   }
 
   typename GraphBuilderT::Ptr
@@ -41,22 +83,75 @@ public:
     typename GraphBuilderT::Ptr gb;
     if (builder_.value == "vg")
     {
-      gb.reset (new pcl::graph::VoxelGridGraphBuilder<PointT, GraphT> (voxel_resolution_));
+      auto vggb = new pcl::graph::VoxelGridGraphBuilder<PointT, GraphT> (voxel_resolution_);
+      if (voxelization_.value == "octree")
+        vggb->setVoxelizationMethod (pcl::graph::VoxelGridGraphBuilder<PointT, GraphT>::VOXELIZATION_OCTREE);
+      vggb->setUseTransform (!no_transform_);
+      vggb->setMaxNumberOfVertices (vertex_budget_);
+      gb.reset (vggb);
+    }
+    else if (builder_.value == "vg-adaptive")
+    {
+      auto avggb = new pcl::graph::AdaptiveVoxelGridGraphBuilder<PointT, GraphT> (voxel_resolution_, num_levels_);
+      avggb->setPlanarityThreshold (planarity_threshold_);
+      avggb->setColorThreshold (color_threshold_);
+      avggb->setUseTransform (!no_transform_);
+      gb.reset (avggb);
     }
     else if (builder_.value == "nnk")
     {
       auto nngb = new pcl::graph::NearestNeighborsGraphBuilder<PointT, GraphT>;
       nngb->setNumberOfNeighbors (number_of_neighbors_);
       nngb->useNearestKSearch ();
+      nngb->setMaxNumberOfVertices (vertex_budget_);
       gb.reset (nngb);
     }
-    else
+    else if (builder_.value == "nnk-approx")
+    {
+      typedef pcl::graph::ApproximateGridSearch<typename GraphBuilderT::PointOutT> SearchT;
+      typename SearchT::Ptr search (new SearchT (rings_));
+      search->setPointsPerCell (number_of_neighbors_);
+      auto nngb = new pcl::graph::NearestNeighborsGraphBuilder<PointT, GraphT>;
+      nngb->setNumberOfNeighbors (number_of_neighbors_);
+      nngb->useNearestKSearch ();
+      nngb->setSearchMethod (search);
+      nngb->setMaxNumberOfVertices (vertex_budget_);
+      gb.reset (nngb);
+    }
+    else if (builder_.value == "nnr")
     {
       auto nngb = new pcl::graph::NearestNeighborsGraphBuilder<PointT, GraphT>;
       nngb->setRadius (radius_);
+      nngb->setNumberOfNeighbors (number_of_neighbors_);
       nngb->useRadiusSearch ();
+      nngb->setMaxNumberOfVertices (vertex_budget_);
       gb.reset (nngb);
     }
+    else if (builder_.value == "nnr-grid")
+    {
+      gb.reset (new pcl::graph::CellListGraphBuilder<PointT, GraphT> (radius_, number_of_neighbors_));
+    }
+    else if (builder_.value == "sv")
+    {
+      auto svgb = new pcl::graph::SupervoxelGraphBuilder<PointT, GraphT> (voxel_resolution_, seed_resolution_);
+      svgb->setColorImportance (color_importance_);
+      svgb->setSpatialImportance (spatial_importance_);
+      svgb->setNormalImportance (normal_importance_);
+      gb.reset (svgb);
+    }
+    else
+    {
+      auto ogb = new pcl::graph::OrganizedGraphBuilder<PointT, GraphT>;
+      if (connectivity_.value == "4")
+        ogb->setConnectivity (pcl::graph::OrganizedGraphBuilder<PointT, GraphT>::CONNECTIVITY_4);
+      ogb->setDepthDiscontinuityThreshold (depth_threshold_);
+      ogb->setBinSize (bin_size_);
+      gb.reset (ogb);
+    }
+    if (ordering_.value == "morton")
+      gb->setVertexOrdering (GraphBuilderT::VERTEX_ORDERING_MORTON);
+    else if (ordering_.value == "rcm")
+      gb->setVertexOrdering (GraphBuilderT::VERTEX_ORDERING_RCM);
     return gb;
   }
 
@@ -64,9 +159,23 @@ private:
 
   EnumOption builder_;
   NumericOption<float> voxel_resolution_;
+  NumericOption<int> vertex_budget_;
+  EnumOption voxelization_;
+  NumericOption<int> num_levels_;
+  NumericOption<float> planarity_threshold_;
+  NumericOption<float> color_threshold_;
+  NumericOption<float> seed_resolution_;
+  NumericOption<float> color_importance_;
+  NumericOption<float> spatial_importance_;
+  NumericOption<float> normal_importance_;
   NumericOption<int> number_of_neighbors_;
   NumericOption<float> radius_;
+  NumericOption<int> rings_;
   BoolOption no_transform_;
+  EnumOption connectivity_;
+  NumericOption<float> depth_threshold_;
+  NumericOption<int> bin_size_;
+  EnumOption ordering_;
 
 };
 
@@ -3,6 +3,10 @@
 
 #include <memory>
 
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+
+#include "io.h"
 #include "factory.h"
 #include "graph_builder_factory.h"
 #include "edge_weight_computer_factory.h"
@@ -25,16 +29,26 @@ public:
   typedef std::vector<GraphRef> GraphRefVector;
   typedef typename pcl::PointCloud<Point>::ConstPtr PointCloudConstPtr;
   typedef typename pcl::graph::GraphBuilder<Point, Graph>::Ptr GraphBuilderPtr;
+  typedef typename pcl::graph::EdgeWeightComputer<Graph>::Ptr EdgeWeightComputerPtr;
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+
+  /** Revision of the graph construction, mixed into the cache key. Has to
+    * be bumped whenever a change in the code makes the produced graphs
+    * differ, so that graphs cached by older versions are not loaded. */
+  static const uint32_t CACHE_VERSION = 1;
 
   GraphFactory ()
   : Factory ("Graph")
   , component_ ("connected component", "--component", -1)
   , smoothing_spatial_ ("smoothing spatial", "--smoothing-spatial", 0.012)
   , smoothing_influence_ ("smoothing influence", "--smoothing-influence", 0.0012)
+  , cache_directory_ ("graph cache directory", "--cache", "")
+  , loaded_from_cache_ (false)
   {
     add (&component_);
     add (&smoothing_spatial_);
     add (&smoothing_influence_);
+    add (&cache_directory_);
   }
 
   virtual const std::string
@@ -61,14 +75,57 @@ public:
     }
   }
 
+  /** Get the signature of the options that affect the produced graph (the
+    * component selection and the cache directory do not). */
+  virtual const std::string
+  getSignature ()
+  {
+    std::stringstream signature;
+    signature << smoothing_spatial_.key << "=" << boost::lexical_cast<std::string> (smoothing_spatial_.value) << ";"
+              << smoothing_influence_.key << "=" << boost::lexical_cast<std::string> (smoothing_influence_.value) << ";";
+    return signature.str () + gb_factory_.getSignature () + wc_factory_.getSignature ();
+  }
+
+  /** Build a graph for the given cloud, as configured by the command line
+    * options.
+    *
+    * If a cache directory is given (--cache), the graph is looked up there
+    * first. The cache is addressed by a hash of the cloud contents and the
+    * values of all options, so a graph built once for the same input and
+    * configuration is loaded instead of being rebuilt. In this case the
+    * graph builder and the edge weight computer are not run (see
+    * isLoadedFromCache()). */
   GraphRef
   instantiate (const PointCloudConstPtr& cloud, int argc, char** argv)
   {
     parse (argc, argv);
     gb_ = gb_factory_.instantiate (argc, argv);
-    auto wc = wc_factory_.instantiate (argc, argv);
-    // Build graph
+    wc_ = wc_factory_.instantiate (argc, argv);
     produced_graph_.reset (new Graph);
+    components_.clear ();
+    loaded_from_cache_ = false;
+
+    std::string cache_filename;
+    if (!cache_directory_.value.empty ())
+    {
+      const boost::filesystem::path path = boost::filesystem::path (cache_directory_.value) /
+                                           boost::str (boost::format ("%016x.graph") % computeCacheKey (*cloud));
+      cache_filename = path.string ();
+      if (boost::filesystem::exists (path))
+      {
+        bool loaded = false;
+        MEASURE_RUNTIME ("Loading graph from cache... ",
+                         loaded = loadGraphBinary (cache_filename, *produced_graph_, point_to_vertex_map_));
+        if (loaded)
+        {
+          loaded_from_cache_ = true;
+          return getComponent ();
+        }
+        pcl::console::print_warn ("Failed to load cached graph \"%s\", rebuilding\n", cache_filename.c_str ());
+      }
+    }
+
+    // Build graph
     gb_->setInputCloud (cloud);
     MEASURE_RUNTIME ("Building graph... ",
                      gb_->compute (*produced_graph_));
@@ -81,12 +138,18 @@ public:
     MEASURE_RUNTIME ("Computing curvature signs... ",
                      pcl::graph::computeSignedCurvatures (*produced_graph_));
     MEASURE_RUNTIME ("Computing edge weights... ",
-                     wc->compute (*produced_graph_));
-    MEASURE_RUNTIME ("Computing connected components... ",
-                     pcl::graph::createSubgraphsFromConnectedComponents (*produced_graph_, components_));
-    if (component_ != -1 && component_ < static_cast<int> (components_.size ()))
-      return components_[component_];
-    return GraphRef (*produced_graph_);
+                     wc_->compute (*produced_graph_));
+    point_to_vertex_map_ = gb_->getPointToVertexMap ();
+
+    if (!cache_filename.empty ())
+    {
+      boost::system::error_code error;
+      boost::filesystem::create_directories (cache_directory_.value, error);
+      if (error || !saveGraphBinary (cache_filename, *produced_graph_, point_to_vertex_map_))
+        pcl::console::print_warn ("Failed to save graph to cache \"%s\"\n", cache_filename.c_str ());
+    }
+
+    return getComponent ();
   }
 
   GraphPtr
@@ -101,25 +164,82 @@ public:
     return components_;
   }
 
+  /** Get a mapping between the points of the input cloud and the vertices
+    * of the produced graph. Unlike the map of the graph builder, this one is
+    * also available when the graph was loaded from the cache. */
+  const std::vector<VertexId>&
+  getPointToVertexMap ()
+  {
+    return point_to_vertex_map_;
+  }
+
   GraphBuilderPtr
   getGraphBuilder ()
   {
     return gb_;
   }
 
+  EdgeWeightComputerPtr
+  getEdgeWeightComputer ()
+  {
+    return wc_;
+  }
+
+  /** Check whether the last produced graph was loaded from the cache. */
+  bool
+  isLoadedFromCache ()
+  {
+    return loaded_from_cache_;
+  }
+
 private:
 
+  GraphRef
+  getComponent ()
+  {
+    MEASURE_RUNTIME ("Computing connected components... ",
+                     pcl::graph::createSubgraphsFromConnectedComponents (*produced_graph_, components_));
+    if (component_ != -1 && component_ < static_cast<int> (components_.size ()))
+      return components_[component_];
+    return GraphRef (*produced_graph_);
+  }
+
+  /** Compute a 64-bit FNV-1a hash of the cache file format and version,
+    * the contents of the cloud, and the signature of this factory. */
+  uint64_t
+  computeCacheKey (const pcl::PointCloud<Point>& cloud)
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    auto update = [&hash] (const unsigned char* data, size_t size)
+    {
+      for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    };
+    update (reinterpret_cast<const unsigned char*> (BINARY_GRAPH_MAGIC), sizeof (BINARY_GRAPH_MAGIC));
+    const uint32_t dimensions[4] = { CACHE_VERSION, cloud.width, cloud.height, sizeof (Point) };
+    update (reinterpret_cast<const unsigned char*> (dimensions), sizeof (dimensions));
+    if (cloud.size ())
+      update (reinterpret_cast<const unsigned char*> (&cloud.points[0]), cloud.size () * sizeof (Point));
+    const std::string signature = getSignature ();
+    update (reinterpret_cast<const unsigned char*> (signature.data ()), signature.size ());
+    return hash;
+  }
+
   NumericOption<int> component_;
   NumericOption<float> smoothing_spatial_;
   NumericOption<float> smoothing_influence_;
+  StringOption cache_directory_;
 
   EdgeWeightComputerFactory<Graph> wc_factory_;
   GraphBuilderFactory<Point, Graph> gb_factory_;
 
   GraphBuilderPtr gb_;
+  EdgeWeightComputerPtr wc_;
 
   GraphPtr produced_graph_;
   GraphRefVector components_;
+  std::vector<VertexId> point_to_vertex_map_;
+  bool loaded_from_cache_;
 
 };
 
@@ -0,0 +1,239 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_ADAPTIVE_VOXEL_GRID_GRAPH_BUILDER_H
+#define PCL_GRAPH_ADAPTIVE_VOXEL_GRID_GRAPH_BUILDER_H
+
+#include "graph/graph_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** This class builds a BGL graph representing an input dataset by using
+      * a voxel grid whose resolution adapts to the local homogeneity of the
+      * data.
+      *
+      * The points are transformed and voxelized at the given (finest)
+      * resolution in the same way as in VoxelGridGraphBuilder. The voxels are
+      * then organized into an octree with a given number of levels above
+      * the finest one, and the octree is traversed top-down: a node becomes a
+      * leaf if its points are homogeneous, otherwise it is subdivided. A node
+      * is considered homogeneous if
+      *
+      * - its points are planar, i.e. the surface variation (the smallest
+      *   eigenvalue of the covariance matrix divided by the sum of the
+      *   eigenvalues) is below the planarity threshold, and
+      * - the standard deviation of its colors (RMS over RGB channels, in the
+      *   0..255 range) is below the color threshold (ignored for point types
+      *   without color).
+      *
+      * Each leaf becomes a vertex positioned at the centroid of its points.
+      * Two leaves (possibly of different sizes) are connected with an edge if
+      * any of their finest-level voxels are adjacent (26-neighborhood). Large
+      * flat uniformly colored surfaces are thus represented with few large
+      * vertices, whereas edges and thin structures keep the finest
+      * resolution.
+      *
+      * For additional information see documentation for \ref GraphBuilder.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT, typename GraphT>
+    class PCL_EXPORTS AdaptiveVoxelGridGraphBuilder : public GraphBuilder<PointT, GraphT>
+    {
+
+        using GraphBuilder<PointT, GraphT>::initCompute;
+        using PCLBase<PointT>::deinitCompute;
+        using PCLBase<PointT>::indices_;
+        using PCLBase<PointT>::input_;
+        using GraphBuilder<PointT, GraphT>::point_to_vertex_map_;
+
+      public:
+
+        using typename GraphBuilder<PointT, GraphT>::PointInT;
+        using typename GraphBuilder<PointT, GraphT>::PointOutT;
+        using typename GraphBuilder<PointT, GraphT>::VertexId;
+
+        /** Constructor.
+          *
+          * \param[in] voxel_resolution resolution of the voxel grid at the
+          * finest level
+          * \param[in] num_levels number of octree levels (the largest voxels
+          * are 2^(num_levels - 1) times larger than the finest ones) */
+        AdaptiveVoxelGridGraphBuilder (float voxel_resolution, size_t num_levels = 4)
+        : voxel_resolution_ (voxel_resolution)
+        , num_levels_ (num_levels)
+        , planarity_threshold_ (0.01f)
+        , color_threshold_ (8.0f)
+        , use_transform_ (true)
+        {
+        }
+
+        virtual void
+        compute (GraphT& graph);
+
+        inline void
+        setVoxelResolution (float resolution)
+        {
+          voxel_resolution_ = resolution;
+        }
+
+        inline float
+        getVoxelResolution () const
+        {
+          return (voxel_resolution_);
+        }
+
+        inline void
+        setNumberOfLevels (size_t num_levels)
+        {
+          num_levels_ = num_levels;
+        }
+
+        inline size_t
+        getNumberOfLevels () const
+        {
+          return (num_levels_);
+        }
+
+        /** Set the maximum surface variation of a node that may become a
+          * leaf. */
+        inline void
+        setPlanarityThreshold (float threshold)
+        {
+          planarity_threshold_ = threshold;
+        }
+
+        inline float
+        getPlanarityThreshold () const
+        {
+          return (planarity_threshold_);
+        }
+
+        /** Set the maximum standard deviation of colors of a node that may
+          * become a leaf. */
+        inline void
+        setColorThreshold (float threshold)
+        {
+          color_threshold_ = threshold;
+        }
+
+        inline float
+        getColorThreshold () const
+        {
+          return (color_threshold_);
+        }
+
+        /** Set whether the points should be transformed to (x/z, y/z, log z)
+          * space before voxelization. */
+        inline void
+        setUseTransform (bool use_transform)
+        {
+          use_transform_ = use_transform;
+        }
+
+        inline bool
+        getUseTransform () const
+        {
+          return (use_transform_);
+        }
+
+      private:
+
+        /// Sums of point coordinates and colors (and their products) of the
+        /// points in an octree node.
+        struct NodeStatistics
+        {
+          NodeStatistics ()
+          : n (0)
+          , xyz (Eigen::Vector3d::Zero ())
+          , xyz_xyz (Eigen::Matrix3d::Zero ())
+          , rgb (Eigen::Vector3d::Zero ())
+          , rgb_rgb (Eigen::Vector3d::Zero ())
+          {
+          }
+
+          NodeStatistics&
+          operator+= (const NodeStatistics& other)
+          {
+            n += other.n;
+            xyz += other.xyz;
+            xyz_xyz += other.xyz_xyz;
+            rgb += other.rgb;
+            rgb_rgb += other.rgb_rgb;
+            return (*this);
+          }
+
+          size_t n;
+          Eigen::Vector3d xyz;
+          Eigen::Matrix3d xyz_xyz;
+          Eigen::Vector3d rgb;
+          Eigen::Vector3d rgb_rgb;
+
+          EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
+        /** Check whether the points of a node satisfy the planarity and color
+          * criteria. */
+        bool
+        isHomogeneous (const NodeStatistics& statistics) const;
+
+        /// Resolution of the voxel grid at the finest level.
+        float voxel_resolution_;
+
+        /// Number of octree levels.
+        size_t num_levels_;
+
+        float planarity_threshold_;
+        float color_threshold_;
+
+        /// Whether the points are transformed before voxelization.
+        bool use_transform_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/adaptive_voxel_grid_graph_builder.hpp"
+
+#endif /* PCL_GRAPH_ADAPTIVE_VOXEL_GRID_GRAPH_BUILDER_H */
+
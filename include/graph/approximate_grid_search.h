@@ -0,0 +1,251 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_APPROXIMATE_GRID_SEARCH_H
+#define PCL_GRAPH_APPROXIMATE_GRID_SEARCH_H
+
+#include <algorithm>
+
+#include <pcl/search/search.h>
+
+#include "graph/voxel_hash.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** Approximate nearest neighbor search based on a uniform grid.
+      *
+      * The points of the input cloud are bucketed into the cells of a uniform
+      * grid (stored in a VoxelHashTable). A k-nearest neighbors query only
+      * examines the points in the cell of the query point and in a given
+      * number of rings of cells around it (see setNumberOfRings()), so the
+      * found neighbors are not necessarily the true nearest neighbors. The
+      * number of rings is the recall knob: examining more rings increases
+      * recall at the cost of speed. Radius queries examine as many rings as
+      * needed to cover the sphere and are therefore exact. The examined
+      * rings are clipped to the extent of the grid, and if they still span
+      * more cells than there are occupied ones, the occupied cells are
+      * scanned instead, so that a large radius does not degrade queries
+      * beyond a linear scan.
+      *
+      * Unless set explicitly with setCellSize(), the cell size is chosen such
+      * that the occupied cells contain a given number of points on average
+      * (see setPointsPerCell()). Setting this number close to the number of
+      * neighbors that will be queried gives a good balance between recall
+      * and speed.
+      *
+      * This class is meant to be plugged into NearestNeighborsGraphBuilder
+      * with setSearchMethod() when building graphs for large unorganized
+      * clouds, where exact kd-tree search dominates the runtime.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT>
+    class ApproximateGridSearch : public pcl::search::Search<PointT>
+    {
+
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::sorted_results_;
+
+      public:
+
+        typedef boost::shared_ptr<ApproximateGridSearch<PointT> > Ptr;
+        typedef typename pcl::search::Search<PointT>::PointCloudConstPtr PointCloudConstPtr;
+        typedef typename pcl::search::Search<PointT>::IndicesConstPtr IndicesConstPtr;
+
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+
+        /** Constructor.
+          *
+          * \param[in] num_rings number of rings of cells around the cell of
+          * the query point examined in k-nearest neighbors search
+          * \param[in] sorted whether the results should be sorted by distance
+          * (k-nearest neighbors results are always sorted) */
+        ApproximateGridSearch (unsigned int num_rings = 1, bool sorted = true)
+        : pcl::search::Search<PointT> ("ApproximateGridSearch", sorted)
+        , num_rings_ (num_rings)
+        , cell_size_ (0.0f)
+        , points_per_cell_ (8)
+        , grid_cell_size_ (1.0f)
+        , grid_origin_ (Eigen::Vector3f::Zero ())
+        , table_ (0)
+        {
+          std::fill (grid_max_, grid_max_ + 3, -1);
+        }
+
+        virtual
+        ~ApproximateGridSearch ()
+        {
+        }
+
+        /** Set the input cloud and bucket its (finite) points into grid
+          * cells. */
+        virtual void
+        setInputCloud (const PointCloudConstPtr& cloud,
+                       const IndicesConstPtr& indices = IndicesConstPtr ());
+
+        /** Search for (approximately) k nearest neighbors of a given point.
+          *
+          * Only the points in the examined rings of cells are considered,
+          * therefore less than \a k neighbors may be returned.
+          *
+          * \return number of neighbors found */
+        virtual int
+        nearestKSearch (const PointT& point,
+                        int k,
+                        std::vector<int>& k_indices,
+                        std::vector<float>& k_sqr_distances) const;
+
+        /** Search for all neighbors of a given point within a sphere of given
+          * radius.
+          *
+          * \return number of neighbors found */
+        virtual int
+        radiusSearch (const PointT& point,
+                      double radius,
+                      std::vector<int>& k_indices,
+                      std::vector<float>& k_sqr_distances,
+                      unsigned int max_nn = 0) const;
+
+        /** Set the number of rings of cells around the cell of the query
+          * point examined in k-nearest neighbors search. Zero means that only
+          * the cell of the query point is examined. */
+        inline void
+        setNumberOfRings (unsigned int num_rings)
+        {
+          num_rings_ = num_rings;
+        }
+
+        inline unsigned int
+        getNumberOfRings () const
+        {
+          return (num_rings_);
+        }
+
+        /** Set the size of grid cells. Zero (default) means that the size
+          * will be chosen automatically when the input cloud is set. */
+        inline void
+        setCellSize (float cell_size)
+        {
+          cell_size_ = cell_size;
+        }
+
+        /** Get the size of grid cells. If automatic selection is enabled,
+          * this returns the size chosen for the current input cloud. */
+        inline float
+        getCellSize () const
+        {
+          return (cell_size_ > 0.0f ? cell_size_ : grid_cell_size_);
+        }
+
+        /** Set the desired average number of points in an occupied cell, used
+          * to choose the cell size automatically. */
+        inline void
+        setPointsPerCell (unsigned int points_per_cell)
+        {
+          points_per_cell_ = points_per_cell;
+        }
+
+        inline unsigned int
+        getPointsPerCell () const
+        {
+          return (points_per_cell_);
+        }
+
+      private:
+
+        /** Compute the (signed) integer grid coordinates of a point. */
+        inline void
+        getCellCoordinates (const PointT& point, int64_t coordinates[3]) const;
+
+        /** Visit all points in the cells within a given number of rings
+          * around the cell of a given point and collect (squared distance,
+          * index) pairs of those that are closer than \a max_sqr_distance. */
+        void
+        collectCandidates (const PointT& point,
+                           unsigned int num_rings,
+                           float max_sqr_distance,
+                           std::vector<std::pair<float, int> >& candidates) const;
+
+        /** Collect (squared distance, index) pairs of the points of a given
+          * cell that are closer than \a max_sqr_distance to a query point. */
+        inline void
+        collectCellCandidates (size_t cell,
+                               const Eigen::Vector3f& query,
+                               float max_sqr_distance,
+                               std::vector<std::pair<float, int> >& candidates) const;
+
+        /** Choose the cell size such that the occupied cells contain
+          * points_per_cell_ points on average. */
+        float
+        estimateCellSize (const std::vector<int>& points) const;
+
+        unsigned int num_rings_;
+        float cell_size_;
+        unsigned int points_per_cell_;
+
+        /// Cell size and origin of the grid built for the current input.
+        float grid_cell_size_;
+        Eigen::Vector3f grid_origin_;
+        /// Maximum cell coordinate along each axis (-1 if the grid is empty).
+        int64_t grid_max_[3];
+
+        /// Maps packed cell keys to cell ids.
+        VoxelHashTable table_;
+        /// Packed keys of the cells, indexed by cell id.
+        std::vector<uint64_t> cell_keys_;
+
+        /// Points of the cell with id i are cell_points_[cell_offsets_[i]] ...
+        /// cell_points_[cell_offsets_[i + 1] - 1].
+        std::vector<size_t> cell_offsets_;
+        std::vector<int> cell_points_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/approximate_grid_search.hpp"
+
+#endif /* PCL_GRAPH_APPROXIMATE_GRID_SEARCH_H */
+
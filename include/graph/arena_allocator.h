@@ -0,0 +1,408 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_ARENA_ALLOCATOR_H
+#define PCL_GRAPH_ARENA_ALLOCATOR_H
+
+#include <new>
+#include <list>
+#include <limits>
+#include <vector>
+#include <cstdlib>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/graph/adjacency_list.hpp>
+
+#include "graph/utils.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** A monotonic memory arena.
+      *
+      * Memory is handed out by bumping a pointer inside large blocks that are
+      * requested from the heap. Individual deallocations are no-ops, the whole
+      * memory is released at once when the arena is destroyed. This makes
+      * allocation of many small objects (such as per-vertex out-edge vectors
+      * and edge list nodes of a graph) very cheap, at the price of never
+      * reusing memory freed in the meantime.
+      *
+      * The first block is allocated lazily with the size given at construction
+      * time (typically an estimate of the total amount of memory that will be
+      * needed). Subsequent blocks are at least as large as the previous one.
+      *
+      * \note The arena is not thread-safe.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    class MonotonicArena : boost::noncopyable
+    {
+
+      public:
+
+        typedef boost::shared_ptr<MonotonicArena> Ptr;
+
+        /** Construct an arena.
+          *
+          * \param[in] initial_size size (in bytes) of the first block */
+        MonotonicArena (size_t initial_size = 1 << 16)
+        : next_block_size_ (std::max<size_t> (initial_size, 256))
+        , head_ (0)
+        , end_ (0)
+        , allocated_bytes_ (0)
+        , used_bytes_ (0)
+        {
+        }
+
+        ~MonotonicArena ()
+        {
+          for (size_t i = 0; i < blocks_.size (); ++i)
+            std::free (blocks_[i]);
+        }
+
+        /** Allocate a chunk of memory with given size and alignment. */
+        void*
+        allocate (size_t bytes, size_t alignment = sizeof (void*))
+        {
+          char* p = align (head_, alignment);
+          if (!head_ || p + bytes > end_)
+          {
+            grow (bytes + alignment);
+            p = align (head_, alignment);
+          }
+          head_ = p + bytes;
+          used_bytes_ += bytes;
+          return (p);
+        }
+
+        /** Total number of bytes requested from the heap. */
+        inline size_t
+        getAllocatedBytes () const
+        {
+          return (allocated_bytes_);
+        }
+
+        /** Total number of bytes handed out to the clients of the arena. */
+        inline size_t
+        getUsedBytes () const
+        {
+          return (used_bytes_);
+        }
+
+        /** Number of blocks requested from the heap. */
+        inline size_t
+        getNumberOfBlocks () const
+        {
+          return (blocks_.size ());
+        }
+
+        /** Access the arena that is currently active in this thread.
+          *
+          * Default-constructed ArenaAllocator objects pick up this arena. A
+          * null pointer means that no arena is active and the allocators
+          * should fall back to the heap. Use ScopedArena to (de)activate
+          * arenas. */
+        static Ptr&
+        current ()
+        {
+          static thread_local Ptr arena;
+          return (arena);
+        }
+
+      private:
+
+        static inline char*
+        align (char* p, size_t alignment)
+        {
+          size_t offset = reinterpret_cast<size_t> (p) % alignment;
+          return (offset ? p + alignment - offset : p);
+        }
+
+        void
+        grow (size_t min_bytes)
+        {
+          size_t size = std::max (next_block_size_, min_bytes);
+          char* block = static_cast<char*> (std::malloc (size));
+          if (!block)
+            throw std::bad_alloc ();
+          blocks_.push_back (block);
+          head_ = block;
+          end_ = block + size;
+          allocated_bytes_ += size;
+          next_block_size_ = size;
+        }
+
+        size_t next_block_size_;
+        std::vector<char*> blocks_;
+        char* head_;
+        char* end_;
+        size_t allocated_bytes_;
+        size_t used_bytes_;
+
+    };
+
+    /** Makes the given arena current for the lifetime of this object, and
+      * restores the previously active arena on destruction.
+      *
+      * Example usage:
+      *
+      * ~~~{.cpp}
+      * {
+      *   ScopedArena scope (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (num_edges))));
+      *   graph = Graph (num_vertices);
+      *   bindEdgeListToCurrentArena (graph);
+      *   // Out-edge vectors and edge list nodes are allocated in the arena
+      *   boost::add_edge (0, 1, graph);
+      * }
+      * // The graph keeps the arena alive, it is released along with the graph
+      * ~~~
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    class ScopedArena : boost::noncopyable
+    {
+
+      public:
+
+        ScopedArena (const MonotonicArena::Ptr& arena)
+        : previous_ (MonotonicArena::current ())
+        {
+          MonotonicArena::current () = arena;
+        }
+
+        ~ScopedArena ()
+        {
+          MonotonicArena::current () = previous_;
+        }
+
+      private:
+
+        MonotonicArena::Ptr previous_;
+
+    };
+
+    /** A standard-compliant allocator that obtains memory from a
+      * MonotonicArena.
+      *
+      * The allocator keeps a shared pointer to the arena, so the arena lives
+      * as long as there are containers that use it. A default-constructed
+      * allocator binds to the arena that is current at the moment of
+      * construction (see ScopedArena). If there is none, the allocator
+      * forwards to the global operator new/delete.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename T>
+    class ArenaAllocator
+    {
+
+      public:
+
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        /* Allocators travel along with the container contents, otherwise
+         * swapping two containers bound to different arenas would be
+         * undefined behavior. */
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        template <typename U>
+        struct rebind
+        {
+          typedef ArenaAllocator<U> other;
+        };
+
+        ArenaAllocator ()
+        : arena_ (MonotonicArena::current ())
+        {
+        }
+
+        ArenaAllocator (const MonotonicArena::Ptr& arena)
+        : arena_ (arena)
+        {
+        }
+
+        template <typename U>
+        ArenaAllocator (const ArenaAllocator<U>& other)
+        : arena_ (other.arena ())
+        {
+        }
+
+        pointer
+        allocate (size_type n, const void* = 0)
+        {
+          if (arena_)
+            return (static_cast<pointer> (arena_->allocate (n * sizeof (T), alignof (T))));
+          return (static_cast<pointer> (::operator new (n * sizeof (T))));
+        }
+
+        void
+        deallocate (pointer p, size_type)
+        {
+          if (!arena_)
+            ::operator delete (p);
+        }
+
+        size_type
+        max_size () const
+        {
+          return (std::numeric_limits<size_type>::max () / sizeof (T));
+        }
+
+        template <typename U, typename... Args> void
+        construct (U* p, Args&&... args)
+        {
+          ::new (static_cast<void*> (p)) U (std::forward<Args> (args)...);
+        }
+
+        template <typename U> void
+        destroy (U* p)
+        {
+          p->~U ();
+        }
+
+        inline const MonotonicArena::Ptr&
+        arena () const
+        {
+          return (arena_);
+        }
+
+      private:
+
+        MonotonicArena::Ptr arena_;
+
+    };
+
+    template <typename T, typename U> inline bool
+    operator== (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+    {
+      return (a.arena () == b.arena ());
+    }
+
+    template <typename T, typename U> inline bool
+    operator!= (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+    {
+      return (a.arena () != b.arena ());
+    }
+
+    /** Rough number of bytes of adjacency storage needed for a graph with the
+      * given number of edges.
+      *
+      * Accounts for two out-edge entries and an edge list node per undirected
+      * edge, plus the slack left behind by out-edge vectors that grow inside
+      * a monotonic arena. */
+    inline size_t
+    estimateArenaSize (size_t num_edges)
+    {
+      return (num_edges * 12 * sizeof (void*));
+    }
+
+    /** Rebind the (empty) edge list of a graph to the arena that is
+      * currently active.
+      *
+      * Assigning a freshly constructed graph to an existing one re-creates
+      * the out-edge vectors, so they pick up the current arena, but the edge
+      * list keeps the allocator of the graph it is assigned to. This
+      * function replaces it with an edge list bound to the current arena.
+      * Should be called right after the graph was (re)created, before any
+      * edges are added. Works both with plain graphs and subgraphs. */
+    template <typename Graph> void
+    bindEdgeListToCurrentArena (Graph& graph)
+    {
+      typedef typename underlying_graph<Graph>::type::EdgeContainer EdgeContainer;
+      EdgeContainer edges;
+      underlying_graph<Graph> () (graph).m_edges.swap (edges);
+    }
+
+    /** Selector for `std::vector` containers with ArenaAllocator, a drop-in
+      * replacement for `boost::vecS` as the OutEdgeList parameter of
+      * point_cloud_graph. */
+    struct arena_vecS { };
+
+    /** Selector for `std::list` containers with ArenaAllocator, a drop-in
+      * replacement for `boost::listS` as the EdgeList parameter of
+      * point_cloud_graph. */
+    struct arena_listS { };
+
+  }
+
+}
+
+namespace boost
+{
+
+  template <class ValueType>
+  struct container_gen<pcl::graph::arena_vecS, ValueType>
+  {
+    typedef std::vector<ValueType, pcl::graph::ArenaAllocator<ValueType> > type;
+  };
+
+  template <class ValueType>
+  struct container_gen<pcl::graph::arena_listS, ValueType>
+  {
+    typedef std::list<ValueType, pcl::graph::ArenaAllocator<ValueType> > type;
+  };
+
+  template <>
+  struct parallel_edge_traits<pcl::graph::arena_vecS>
+  {
+    typedef allow_parallel_edge_tag type;
+  };
+
+  template <>
+  struct parallel_edge_traits<pcl::graph::arena_listS>
+  {
+    typedef allow_parallel_edge_tag type;
+  };
+
+}
+
+#endif /* PCL_GRAPH_ARENA_ALLOCATOR_H */
@@ -0,0 +1,146 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_CELL_LIST_GRAPH_BUILDER_H
+#define PCL_GRAPH_CELL_LIST_GRAPH_BUILDER_H
+
+#include "graph/graph_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** This class builds a point cloud graph representing an input dataset by
+      * connecting all points that are within a given radius from each other.
+      *
+      * The result is the same as with NearestNeighborsGraphBuilder in radius
+      * search mode, but no search structure is involved. The points are
+      * counting-sorted into the cells of a uniform grid with cell size equal
+      * to the radius, so all neighbors of a point are in the 27 cells around
+      * it. The cells are swept in parallel and each pair of adjacent cells is
+      * visited only once (half stencil), thus every candidate pair of points
+      * is examined exactly once.
+      *
+      * Optionally, the number of neighbors of a point may be limited (see
+      * setNumberOfNeighbors()). In this case each point is connected only to
+      * its nearest neighbors within the radius (and, of course, to the points
+      * that have it among their nearest neighbors).
+      *
+      * As with NearestNeighborsGraphBuilder, the data contained in the points
+      * of the input cloud will be copied inside the vertices of the newly
+      * created graph.
+      *
+      * For additional information see documentation for \ref GraphBuilder.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT, typename GraphT>
+    class PCL_EXPORTS CellListGraphBuilder : public GraphBuilder<PointT, GraphT>
+    {
+
+        using GraphBuilder<PointT, GraphT>::initCompute;
+        using PCLBase<PointT>::deinitCompute;
+        using PCLBase<PointT>::indices_;
+        using PCLBase<PointT>::input_;
+        using GraphBuilder<PointT, GraphT>::point_to_vertex_map_;
+
+      public:
+
+        using typename GraphBuilder<PointT, GraphT>::PointInT;
+        using typename GraphBuilder<PointT, GraphT>::PointOutT;
+        using typename GraphBuilder<PointT, GraphT>::VertexId;
+
+        /** Constructor.
+          *
+          * \param[in] radius sphere radius
+          * \param[in] num_neighbors maximum number of neighbors of a point
+          * (0 means no limit) */
+        CellListGraphBuilder (float radius, size_t num_neighbors = 0)
+        : radius_ (radius)
+        , num_neighbors_ (num_neighbors)
+        {
+        }
+
+        virtual void
+        compute (GraphT& graph);
+
+        inline void
+        setRadius (float radius)
+        {
+          radius_ = radius;
+        }
+
+        inline float
+        getRadius () const
+        {
+          return (radius_);
+        }
+
+        /** Set the maximum number of neighbors of a point (0 means no
+          * limit). */
+        inline void
+        setNumberOfNeighbors (size_t num_neighbors)
+        {
+          num_neighbors_ = num_neighbors;
+        }
+
+        inline size_t
+        getNumberOfNeighbors () const
+        {
+          return (num_neighbors_);
+        }
+
+      private:
+
+        /// Sphere radius (and grid cell size).
+        float radius_;
+
+        /// Maximum number of neighbors of a point.
+        size_t num_neighbors_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/cell_list_graph_builder.hpp"
+
+#endif /* PCL_GRAPH_CELL_LIST_GRAPH_BUILDER_H */
+
@@ -0,0 +1,242 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_COARSENING_H
+#define PCL_GRAPH_COARSENING_H
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+#include "graph/point_cloud_graph.h"
+#include "graph/point_cloud_graph_concept.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** Coarsen a graph by contracting the edges of a heavy-edge matching.
+      *
+      * The vertices of the input graph are visited in order. Each unmatched
+      * vertex is matched with the unmatched neighbor it is connected to with
+      * the heaviest edge (if any). Every pair of matched vertices (and every
+      * vertex that remained unmatched) becomes a single vertex of the coarse
+      * graph. The point of a coarse vertex is the average of the points of
+      * the fine vertices it aggregates (see octree::AveragePoint). The weight
+      * of an edge between two coarse vertices is the sum of the weights of
+      * the fine edges between the aggregates.
+      *
+      * Coarse vertices are numbered in the order of the lowest fine vertex
+      * they aggregate, so the spatial locality of the fine vertex order (e.g.
+      * after reorderVertices()) carries over to the coarse graph.
+      *
+      * \c Graph has to be a model of concepts::PointCloudGraphConcept and
+      * should have an internal edge weight property.
+      *
+      * \param[in]  fine an input graph
+      * \param[out] coarse the coarsened graph
+      * \param[out] fine_to_coarse a mapping between the vertices of the fine
+      *             and the coarse graphs
+      *
+      * \return the number of vertices in the coarse graph
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename Graph> size_t
+    coarsenGraph (const Graph& fine,
+                  Graph& coarse,
+                  std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& fine_to_coarse);
+
+
+    /** This class builds a multilevel hierarchy of graphs by repeated
+      * application of coarsenGraph().
+      *
+      * Level \c 0 is the input graph, each subsequent level is a coarsened
+      * version of the previous one. Coarsening stops when the maximum number
+      * of levels is reached, the graph becomes smaller than the given minimum
+      * number of vertices, or when a coarsening step fails to shrink the
+      * graph sufficiently (e.g. because there are no edges left to contract).
+      *
+      * The points of the vertices at each level are the averages of all the
+      * points of the input graph that they aggregate.
+      *
+      * The hierarchy keeps the mappings between the vertices of adjacent
+      * levels, which allows to transfer per-vertex data (such as labels or
+      * potentials) computed on a coarse level back to the finer levels with
+      * prolongate().
+      *
+      * Example usage:
+      *
+      * ~~~{.cpp}
+      * GraphHierarchy<Graph> hierarchy;
+      * hierarchy.setMaxNumberOfLevels (5);
+      * hierarchy.compute (graph);
+      * // Solve on the coarsest level
+      * std::vector<uint32_t> labels = solve (*hierarchy.getLevel (hierarchy.getNumberOfLevels () - 1));
+      * // Transfer the solution to the input graph
+      * for (size_t level = hierarchy.getNumberOfLevels () - 1; level > 0; --level)
+      *   hierarchy.prolongate (level, labels, labels);
+      * ~~~
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename GraphT>
+    class GraphHierarchy
+    {
+
+        BOOST_CONCEPT_ASSERT ((pcl::graph::PointCloudGraphConcept<GraphT>));
+
+      public:
+
+        typedef boost::shared_ptr<GraphT> GraphPtr;
+        typedef typename boost::graph_traits<GraphT>::vertex_descriptor VertexId;
+
+        /** Construct a hierarchy builder with default settings.
+          *
+          * By default at most 10 levels are built, coarsening stops when the
+          * graph has less than 100 vertices or a step removes less than 10% of
+          * the vertices. */
+        GraphHierarchy ()
+        : max_num_levels_ (10)
+        , min_num_vertices_ (100)
+        , min_reduction_ (0.1f)
+        {
+        }
+
+        /** Build a hierarchy for a given graph.
+          *
+          * The graph is stored (not copied) as level \c 0. */
+        void
+        compute (const GraphPtr& graph);
+
+        /** Get the number of levels in the hierarchy (including the input
+          * graph). */
+        inline size_t
+        getNumberOfLevels () const
+        {
+          return (levels_.size ());
+        }
+
+        /** Get the graph at a given level. */
+        inline GraphPtr
+        getLevel (size_t level) const
+        {
+          return (levels_.at (level));
+        }
+
+        /** Get the mapping between the vertices of a given level and the
+          * vertices of the next (coarser) level. */
+        inline const std::vector<VertexId>&
+        getFineToCoarseMap (size_t level) const
+        {
+          return (fine_to_coarse_.at (level));
+        }
+
+        /** Transfer per-vertex data from a given level to the previous (finer)
+          * level.
+          *
+          * Each fine vertex gets the value of the coarse vertex it was
+          * aggregated into. The input and output vectors may be the same
+          * object.
+          *
+          * \param[in]  level a level to transfer data from (should be > 0)
+          * \param[in]  coarse_data values for the vertices of \a level
+          * \param[out] fine_data values for the vertices of \a level - 1 */
+        template <typename T> void
+        prolongate (size_t level,
+                    const std::vector<T>& coarse_data,
+                    std::vector<T>& fine_data) const;
+
+        inline void
+        setMaxNumberOfLevels (size_t max_num_levels)
+        {
+          max_num_levels_ = max_num_levels;
+        }
+
+        inline size_t
+        getMaxNumberOfLevels () const
+        {
+          return (max_num_levels_);
+        }
+
+        inline void
+        setMinNumberOfVertices (size_t min_num_vertices)
+        {
+          min_num_vertices_ = min_num_vertices;
+        }
+
+        inline size_t
+        getMinNumberOfVertices () const
+        {
+          return (min_num_vertices_);
+        }
+
+        /** Set the minimum fraction of vertices that a coarsening step should
+          * remove to be considered successful. */
+        inline void
+        setMinReduction (float min_reduction)
+        {
+          min_reduction_ = min_reduction;
+        }
+
+        inline float
+        getMinReduction () const
+        {
+          return (min_reduction_);
+        }
+
+      private:
+
+        size_t max_num_levels_;
+        size_t min_num_vertices_;
+        float min_reduction_;
+
+        std::vector<GraphPtr> levels_;
+        std::vector<std::vector<VertexId> > fine_to_coarse_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/coarsening.hpp"
+
+#endif /* PCL_GRAPH_COARSENING_H */
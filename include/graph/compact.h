@@ -0,0 +1,110 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_COMPACT_H
+#define PCL_GRAPH_COMPACT_H
+
+#include <vector>
+
+#include <boost/graph/graph_traits.hpp>
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** Remove all vertices that do not satisfy a predicate from a graph.
+      *
+      * Removing vertices one by one with boost::remove_vertex() is expensive
+      * for point cloud graphs: each call shifts the points stored in the
+      * graph and renumbers the edges, so dropping \c k vertices costs
+      * O(k·(V+E)). This function instead rebuilds the graph (points, vertex
+      * and edge properties) in a single linear pass, preserving the relative
+      * order of the remaining vertices. Edges incident to removed vertices
+      * are dropped.
+      *
+      * In case of subgraphs, the graph should be a root without children (the
+      * children would be invalidated anyway).
+      *
+      * \c Graph has to be a model of concepts::PointCloudGraphConcept.
+      *
+      * \param[in,out] graph a graph to compact
+      * \param[in]     keep a unary predicate that takes a vertex descriptor
+      *                and returns \c true if the vertex should be kept
+      *
+      * \return a mapping between old and new vertex ids, removed vertices are
+      * mapped to std::numeric_limits<VertexId>::max ()
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename Graph, typename Predicate>
+    std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>
+    compactGraph (Graph& graph, Predicate keep);
+
+
+    /** Remove all vertices that do not satisfy a predicate from a graph and
+      * update a point to vertex map (as produced by GraphBuilder)
+      * accordingly.
+      *
+      * This is an overloaded function provided for convenience. See the
+      * documentation for compactGraph(). Points that were associated with
+      * removed vertices get the "nil" vertex id.
+      *
+      * \param[in,out] graph a graph to compact
+      * \param[in]     keep a unary predicate that takes a vertex descriptor
+      *                and returns \c true if the vertex should be kept
+      * \param[in,out] point_to_vertex_map a mapping between points and graph
+      *                vertices
+      *
+      * \return a mapping between old and new vertex ids
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename Graph, typename Predicate>
+    std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>
+    compactGraph (Graph& graph,
+                  Predicate keep,
+                  std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& point_to_vertex_map);
+
+  }
+
+}
+
+#include "graph/impl/compact.hpp"
+
+#endif /* PCL_GRAPH_COMPACT_H */
@@ -40,6 +40,7 @@
 
 #include <boost/function.hpp>
 
+#include "graph/memory_usage.h"
 #include "graph/point_cloud_graph.h"
 #include "graph/point_cloud_graph_concept.h"
 
@@ -327,6 +328,14 @@ namespace pcl
           balancing_function_ = func;
         }
 
+        /** Get a report of the memory used by the buffers of the normalized
+          * terms.
+          *
+          * The buffers are allocated in compute() and are kept until the next
+          * invocation. */
+        MemoryReport
+        getMemoryUsage () const;
+
       private:
 
         /** Gaussian, used as a balancing function by default. */
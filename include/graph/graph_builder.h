@@ -38,10 +38,13 @@
 #ifndef PCL_GRAPH_GRAPH_BUILDER_H
 #define PCL_GRAPH_GRAPH_BUILDER_H
 
+#include <vector>
+
 #include <boost/concept_check.hpp>
 
 #include <pcl/pcl_base.h>
 
+#include "graph/reorder.h"
 #include "graph/point_cloud_graph.h"
 #include "graph/point_cloud_graph_concept.h"
 
@@ -51,6 +54,27 @@ namespace pcl
   namespace graph
   {
 
+    /** Mapping between graph vertices and the points of the input cloud,
+      * stored in compressed sparse row form.
+      *
+      * The indices of the points that belong to vertex \c v are
+      * \c indices[offsets[v]] ... \c indices[offsets[v + 1] - 1], listed in
+      * increasing order. */
+    struct VertexToPointsMap
+    {
+      /// Start of the points of each vertex in \c indices, plus the total.
+      std::vector<size_t> offsets;
+      /// Indices of the points, grouped by vertex.
+      std::vector<int> indices;
+
+      /** Get the number of points that belong to a given vertex. */
+      inline size_t
+      getNumberOfPoints (size_t v) const
+      {
+        return (offsets[v + 1] - offsets[v]);
+      }
+    };
+
     /** This is an abstract base class for building a BGL-compatible point cloud
       * graph from a point cloud.
       *
@@ -83,10 +107,45 @@ namespace pcl
 
         typedef typename boost::graph_traits<GraphT>::vertex_descriptor VertexId;
 
+        /** Orders in which the vertices of the output graph may be arranged.
+          *
+          * The default order depends on the extending class and typically is
+          * not cache-friendly. The other orders make the vertices that are
+          * adjacent in the graph close in memory as well, which speeds up the
+          * subsequent algorithms iterating over edges. */
+        enum VertexOrdering
+        {
+          /// Keep the order in which the vertices were created.
+          VERTEX_ORDERING_NONE,
+          /// Sort vertices along the Morton curve, see computeMortonOrder().
+          VERTEX_ORDERING_MORTON,
+          /// Reverse Cuthill-McKee, see computeReverseCuthillMcKeeOrder().
+          VERTEX_ORDERING_RCM,
+        };
+
+        GraphBuilder ()
+        : vertex_ordering_ (VERTEX_ORDERING_NONE)
+        {
+        }
+
         /** Build a graph based on the provided input data. */
         virtual void
         compute (GraphT& graph) = 0;
 
+        /** Set the order in which the vertices of the output graph should be
+          * arranged. */
+        inline void
+        setVertexOrdering (VertexOrdering ordering)
+        {
+          vertex_ordering_ = ordering;
+        }
+
+        inline VertexOrdering
+        getVertexOrdering () const
+        {
+          return (vertex_ordering_);
+        }
+
         /** Get a mapping between points in the input cloud and the vertices in
           * the output graph.
           *
@@ -101,10 +160,84 @@ namespace pcl
           return (point_to_vertex_map_);
         }
 
+        /** Get a mapping between the vertices in the output graph and the
+          * points in the input cloud (inverse of getPointToVertexMap()).
+          *
+          * The points that have no corresponding vertex are not listed. */
+        const VertexToPointsMap&
+        getVertexToPointsMap () const
+        {
+          return (vertex_to_points_map_);
+        }
+
       protected:
 
+        /** Same as PCLBase::initCompute(), additionally resets the vertex
+          * to points map, so that it stays empty if compute() fails. */
+        bool
+        initCompute ()
+        {
+          vertex_to_points_map_.offsets.assign (1, 0);
+          vertex_to_points_map_.indices.clear ();
+          return (pcl::PCLBase<PointT>::initCompute ());
+        }
+
+        /** Build the vertex to points map from the point to vertex map with
+          * a counting sort. Called by applyVertexOrdering(). */
+        void
+        computeVertexToPointsMap (size_t num_vertices)
+        {
+          std::vector<size_t>& offsets = vertex_to_points_map_.offsets;
+          std::vector<int>& indices = vertex_to_points_map_.indices;
+          offsets.assign (num_vertices + 1, 0);
+          for (size_t i = 0; i < point_to_vertex_map_.size (); ++i)
+            if (point_to_vertex_map_[i] < num_vertices)
+              ++offsets[point_to_vertex_map_[i] + 1];
+          for (size_t v = 0; v < num_vertices; ++v)
+            offsets[v + 1] += offsets[v];
+          indices.resize (offsets[num_vertices]);
+          std::vector<size_t> next (offsets.begin (), offsets.end () - 1);
+          for (size_t i = 0; i < point_to_vertex_map_.size (); ++i)
+            if (point_to_vertex_map_[i] < num_vertices)
+              indices[next[point_to_vertex_map_[i]]++] = i;
+        }
+
+        /** Permute the vertices of a freshly built graph according to the
+          * vertex ordering set by the user. Keeps the point to vertex map in
+          * sync and builds the vertex to points map. Should be called by
+          * extending classes at the end of compute(). */
+        void
+        applyVertexOrdering (GraphT& graph)
+        {
+          std::vector<VertexId> order;
+          switch (vertex_ordering_)
+          {
+            case VERTEX_ORDERING_NONE:
+              {
+                break;
+              }
+            case VERTEX_ORDERING_MORTON:
+              {
+                computeMortonOrder (graph, order);
+                break;
+              }
+            case VERTEX_ORDERING_RCM:
+              {
+                computeReverseCuthillMcKeeOrder (graph, order);
+                break;
+              }
+          }
+          if (!order.empty ())
+            reorderVertices (graph, order, point_to_vertex_map_);
+          computeVertexToPointsMap (boost::num_vertices (graph));
+        }
+
         std::vector<VertexId> point_to_vertex_map_;
 
+        VertexToPointsMap vertex_to_points_map_;
+
+        VertexOrdering vertex_ordering_;
+
     };
 
   }
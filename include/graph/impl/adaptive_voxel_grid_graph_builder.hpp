@@ -0,0 +1,305 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_ADAPTIVE_VOXEL_GRID_GRAPH_BUILDER_HPP
+#define PCL_GRAPH_IMPL_ADAPTIVE_VOXEL_GRID_GRAPH_BUILDER_HPP
+
+#include <algorithm>
+
+#include <boost/utility/enable_if.hpp>
+
+#include <Eigen/Eigenvalues>
+
+#include <pcl/console/print.h>
+#include <pcl/common/common.h>
+#include <pcl/common/centroid.h>
+
+#include "graph/voxel_grid_graph_builder.h"
+#include "graph/adaptive_voxel_grid_graph_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    namespace detail
+    {
+
+      /* ColorMoments accumulates the sums of the RGB channels and of their
+       * squares. The version for the point types without color does
+       * nothing. */
+
+      template <typename PointT, typename Enable = void>
+      struct ColorMoments
+      {
+        static void
+        add (const PointT&, Eigen::Vector3d&, Eigen::Vector3d&)
+        {
+        }
+      };
+
+      template <typename PointT>
+      struct ColorMoments<PointT, typename boost::enable_if<pcl::traits::has_color<PointT> >::type>
+      {
+        static void
+        add (const PointT& p, Eigen::Vector3d& sum, Eigen::Vector3d& sum_sq)
+        {
+          const Eigen::Vector3d c (p.r, p.g, p.b);
+          sum += c;
+          sum_sq += c.cwiseProduct (c);
+        }
+      };
+
+    }
+
+  }
+
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::AdaptiveVoxelGridGraphBuilder<PointT, GraphT>::compute (GraphT& graph)
+{
+  using namespace detail;
+
+  if (!initCompute ())
+  {
+    graph = GraphT ();
+    deinitCompute ();
+    return;
+  }
+
+  const VertexId nil = std::numeric_limits<VertexId>::max ();
+
+  pcl::PointCloud<pcl::PointXYZ> transformed;
+  transformPoints (*input_, use_transform_, transformed);
+  Eigen::Vector4f min, max;
+  pcl::getMinMax3D (transformed, *indices_, min, max);
+
+  std::vector<KeyIndexPair> pairs;
+  unsigned int depth;
+  if (!computeSortedVoxelCodes (transformed, *indices_, min, max, voxel_resolution_, pairs, depth))
+  {
+    PCL_ERROR ("[pcl::graph::AdaptiveVoxelGridGraphBuilder::compute] Voxel grid is too fine for the extent of the input cloud.\n");
+    graph = GraphT ();
+    point_to_vertex_map_.assign (input_->size (), nil);
+    deinitCompute ();
+    return;
+  }
+  const size_t num_levels = std::min<size_t> (std::max<size_t> (num_levels_, 1), depth + 1);
+
+  // Step 1: find the finest voxels (runs of equal codes) and the nodes of
+  // the coarser levels (runs of voxels of the previous level with equal code
+  // prefixes). For each node keep the range of its points and children.
+  std::vector<std::vector<uint64_t> > codes (num_levels);
+  std::vector<std::vector<size_t> > point_begin (num_levels);
+  std::vector<std::vector<size_t> > child_begin (num_levels);
+  for (size_t i = 0; i < pairs.size (); ++i)
+  {
+    if (i == 0 || pairs[i].code != pairs[i - 1].code)
+    {
+      point_begin[0].push_back (i);
+      codes[0].push_back (pairs[i].code);
+    }
+  }
+  point_begin[0].push_back (pairs.size ());
+  for (size_t level = 1; level < num_levels; ++level)
+  {
+    const std::vector<uint64_t>& fine = codes[level - 1];
+    for (size_t i = 0; i < fine.size (); ++i)
+    {
+      if (i == 0 || (fine[i] >> 3) != codes[level].back ())
+      {
+        child_begin[level].push_back (i);
+        codes[level].push_back (fine[i] >> 3);
+        point_begin[level].push_back (point_begin[level - 1][i]);
+      }
+    }
+    child_begin[level].push_back (fine.size ());
+    point_begin[level].push_back (pairs.size ());
+  }
+
+  // Step 2: compute the statistics of the finest voxels and sum them up
+  // the levels.
+  std::vector<std::vector<NodeStatistics, Eigen::aligned_allocator<NodeStatistics> > > statistics (num_levels);
+  statistics[0].resize (codes[0].size ());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int> (codes[0].size ()); ++i)
+  {
+    NodeStatistics& s = statistics[0][i];
+    for (size_t j = point_begin[0][i]; j < point_begin[0][i + 1]; ++j)
+    {
+      const PointInT& p = input_->operator[] (pairs[j].index);
+      const Eigen::Vector3d xyz = p.getVector3fMap ().template cast<double> ();
+      s.xyz += xyz;
+      s.xyz_xyz += xyz * xyz.transpose ();
+      ColorMoments<PointInT>::add (p, s.rgb, s.rgb_rgb);
+    }
+    s.n = point_begin[0][i + 1] - point_begin[0][i];
+  }
+  for (size_t level = 1; level < num_levels; ++level)
+  {
+    statistics[level].resize (codes[level].size ());
+    for (size_t i = 0; i < codes[level].size (); ++i)
+      for (size_t j = child_begin[level][i]; j < child_begin[level][i + 1]; ++j)
+        statistics[level][i] += statistics[level - 1][j];
+  }
+
+  // Step 3: traverse the octree top-down (depth-first, so that the leaves
+  // are output in Morton order) and collect the leaves.
+  std::vector<std::pair<size_t, size_t> > leaves;
+  {
+    std::vector<std::pair<size_t, size_t> > stack;
+    for (size_t i = codes[num_levels - 1].size (); i-- > 0; )
+      stack.push_back (std::make_pair (num_levels - 1, i));
+    while (!stack.empty ())
+    {
+      const std::pair<size_t, size_t> node = stack.back ();
+      stack.pop_back ();
+      if (node.first == 0 || isHomogeneous (statistics[node.first][node.second]))
+      {
+        leaves.push_back (node);
+        continue;
+      }
+      for (size_t j = child_begin[node.first][node.second + 1]; j-- > child_begin[node.first][node.second]; )
+        stack.push_back (std::make_pair (node.first - 1, j));
+    }
+  }
+
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (13 * leaves.size ()))));
+
+  graph = GraphT (leaves.size ());
+  bindEdgeListToCurrentArena (graph);
+
+  point_to_vertex_map_.clear ();
+  point_to_vertex_map_.resize (input_->size (), nil);
+
+  // Step 4: compute leaf centroids, fill in the point to vertex map, and
+  // record the leaf of every finest voxel.
+  std::vector<VertexId> voxel_to_vertex (codes[0].size ());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int> (leaves.size ()); ++i)
+  {
+    const VertexId v = i;
+    const size_t level = leaves[v].first;
+    const size_t node = leaves[v].second;
+    pcl::CentroidPoint<PointInT> centroid;
+    for (size_t j = point_begin[level][node]; j < point_begin[level][node + 1]; ++j)
+    {
+      centroid.add (input_->operator[] (pairs[j].index));
+      point_to_vertex_map_[pairs[j].index] = v;
+    }
+    centroid.get (graph[v]);
+    // Descend to the range of the finest voxels of the node
+    size_t begin = node;
+    size_t end = node + 1;
+    for (size_t l = level; l > 0; --l)
+    {
+      begin = child_begin[l][begin];
+      end = child_begin[l][end];
+    }
+    std::fill (voxel_to_vertex.begin () + begin, voxel_to_vertex.begin () + end, v);
+  }
+
+  // Step 5: connect the leaves that contain adjacent finest voxels.
+  std::vector<uint64_t> voxel_keys (codes[0].size ());
+  for (size_t i = 0; i < voxel_keys.size (); ++i)
+  {
+    const uint64_t code = codes[0][i];
+    voxel_keys[i] = packVoxelKey (compactBits3 (code >> 2), compactBits3 (code >> 1), compactBits3 (code));
+  }
+  VoxelHashTable table (voxel_keys.size ());
+  for (size_t i = 0; i < voxel_keys.size (); ++i)
+    table.insert (voxel_keys[i], i);
+  std::vector<std::pair<VertexId, VertexId> > edges;
+  for (size_t i = 0; i < voxel_keys.size (); ++i)
+  {
+    uint32_t x, y, z;
+    unpackVoxelKey (voxel_keys[i], x, y, z);
+    for (size_t j = 0; j < 13; ++j)
+    {
+      const uint32_t nx = x + HALF_STENCIL[j][0];
+      const uint32_t ny = y + HALF_STENCIL[j][1];
+      const uint32_t nz = z + HALF_STENCIL[j][2];
+      // Negative coordinates wrap around and are caught here as well
+      if (nx >= MAX_VOXEL_KEY || ny >= MAX_VOXEL_KEY || nz >= MAX_VOXEL_KEY)
+        continue;
+      size_t neighbor;
+      if (!table.find (packVoxelKey (nx, ny, nz), neighbor))
+        continue;
+      const VertexId v1 = voxel_to_vertex[i];
+      const VertexId v2 = voxel_to_vertex[neighbor];
+      if (v1 != v2)
+        edges.push_back (std::make_pair (std::min (v1, v2), std::max (v1, v2)));
+    }
+  }
+  std::sort (edges.begin (), edges.end ());
+  edges.erase (std::unique (edges.begin (), edges.end ()), edges.end ());
+  for (size_t i = 0; i < edges.size (); ++i)
+    boost::add_edge (edges[i].first, edges[i].second, graph);
+
+  this->applyVertexOrdering (graph);
+  deinitCompute ();
+}
+
+template <typename PointT, typename GraphT> bool
+pcl::graph::AdaptiveVoxelGridGraphBuilder<PointT, GraphT>::isHomogeneous (const NodeStatistics& statistics) const
+{
+  // Too few points to estimate the local geometry
+  if (statistics.n < 3)
+    return (true);
+
+  const double n = static_cast<double> (statistics.n);
+  const Eigen::Vector3d mean = statistics.xyz / n;
+  const Eigen::Matrix3d covariance = statistics.xyz_xyz / n - mean * mean.transpose ();
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (covariance, Eigen::EigenvaluesOnly);
+  const Eigen::Vector3d eigenvalues = solver.eigenvalues ().cwiseMax (0.0);
+  const double sum = eigenvalues.sum ();
+  if (sum > 0.0 && eigenvalues[0] / sum > planarity_threshold_)
+    return (false);
+
+  const Eigen::Vector3d color_mean = statistics.rgb / n;
+  const Eigen::Vector3d color_variance = statistics.rgb_rgb / n - color_mean.cwiseProduct (color_mean);
+  return (std::sqrt (std::max (color_variance.mean (), 0.0)) <= color_threshold_);
+}
+
+#endif /* PCL_GRAPH_IMPL_ADAPTIVE_VOXEL_GRID_GRAPH_BUILDER_HPP */
+
@@ -0,0 +1,285 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_APPROXIMATE_GRID_SEARCH_HPP
+#define PCL_GRAPH_IMPL_APPROXIMATE_GRID_SEARCH_HPP
+
+#include <cmath>
+#include <algorithm>
+
+#include <pcl/common/point_tests.h>
+
+#include "graph/approximate_grid_search.h"
+
+template <typename PointT> void
+pcl::graph::ApproximateGridSearch<PointT>::setInputCloud (const PointCloudConstPtr& cloud,
+                                                          const IndicesConstPtr& indices)
+{
+  input_ = cloud;
+  indices_ = indices;
+
+  std::vector<int> points;
+  points.reserve (indices ? indices->size () : cloud->size ());
+  for (size_t i = 0; i < (indices ? indices->size () : cloud->size ()); ++i)
+  {
+    const int index = indices ? indices->operator[] (i) : static_cast<int> (i);
+    if (pcl::isFinite (cloud->operator[] (index)))
+      points.push_back (index);
+  }
+
+  Eigen::Vector3f min_pt = Eigen::Vector3f::Constant (std::numeric_limits<float>::max ());
+  Eigen::Vector3f max_pt = Eigen::Vector3f::Constant (-std::numeric_limits<float>::max ());
+  for (size_t i = 0; i < points.size (); ++i)
+  {
+    const Eigen::Vector3f p = cloud->operator[] (points[i]).getVector3fMap ();
+    min_pt = min_pt.cwiseMin (p);
+    max_pt = max_pt.cwiseMax (p);
+  }
+  grid_origin_ = min_pt;
+
+  // Choose cell size, but make sure that the grid coordinates fit in the
+  // packed keys.
+  grid_cell_size_ = cell_size_ > 0.0f ? cell_size_ : estimateCellSize (points);
+  if (!points.empty ())
+    grid_cell_size_ = std::max (grid_cell_size_, (max_pt - min_pt).maxCoeff () / (MAX_VOXEL_KEY - 2));
+
+  // Bucket the points into cells. Cell ids are assigned in the order of
+  // first appearance, then points are grouped by cell (counting sort).
+  table_ = VoxelHashTable (points.size ());
+  cell_keys_.clear ();
+  std::fill (grid_max_, grid_max_ + 3, -1);
+  std::vector<size_t> point_cell (points.size ());
+  std::vector<size_t> counts;
+  for (size_t i = 0; i < points.size (); ++i)
+  {
+    int64_t c[3];
+    getCellCoordinates (cloud->operator[] (points[i]), c);
+    const uint64_t key = packVoxelKey (c[0], c[1], c[2]);
+    size_t cell;
+    if (!table_.find (key, cell))
+    {
+      cell = counts.size ();
+      table_.insert (key, cell);
+      cell_keys_.push_back (key);
+      counts.push_back (0);
+      for (size_t j = 0; j < 3; ++j)
+        grid_max_[j] = std::max (grid_max_[j], c[j]);
+    }
+    point_cell[i] = cell;
+    ++counts[cell];
+  }
+  cell_offsets_.assign (counts.size () + 1, 0);
+  for (size_t i = 0; i < counts.size (); ++i)
+    cell_offsets_[i + 1] = cell_offsets_[i] + counts[i];
+  cell_points_.resize (points.size ());
+  std::vector<size_t> next (cell_offsets_.begin (), cell_offsets_.end () - 1);
+  for (size_t i = 0; i < points.size (); ++i)
+    cell_points_[next[point_cell[i]]++] = points[i];
+}
+
+template <typename PointT> int
+pcl::graph::ApproximateGridSearch<PointT>::nearestKSearch (const PointT& point,
+                                                           int k,
+                                                           std::vector<int>& k_indices,
+                                                           std::vector<float>& k_sqr_distances) const
+{
+  std::vector<std::pair<float, int> > candidates;
+  if (k > 0 && pcl::isFinite (point))
+    collectCandidates (point, num_rings_, std::numeric_limits<float>::max (), candidates);
+
+  const size_t num_found = std::min (candidates.size (), static_cast<size_t> (std::max (k, 0)));
+  std::partial_sort (candidates.begin (), candidates.begin () + num_found, candidates.end ());
+  k_indices.resize (num_found);
+  k_sqr_distances.resize (num_found);
+  for (size_t i = 0; i < num_found; ++i)
+  {
+    k_sqr_distances[i] = candidates[i].first;
+    k_indices[i] = candidates[i].second;
+  }
+  return (static_cast<int> (num_found));
+}
+
+template <typename PointT> int
+pcl::graph::ApproximateGridSearch<PointT>::radiusSearch (const PointT& point,
+                                                         double radius,
+                                                         std::vector<int>& k_indices,
+                                                         std::vector<float>& k_sqr_distances,
+                                                         unsigned int max_nn) const
+{
+  std::vector<std::pair<float, int> > candidates;
+  if (radius >= 0.0 && pcl::isFinite (point))
+  {
+    // Rings beyond the extent of the grid are clipped anyway
+    const double max_rings = MAX_VOXEL_KEY;
+    const unsigned int num_rings = static_cast<unsigned int> (std::min (std::ceil (radius / grid_cell_size_), max_rings));
+    collectCandidates (point, num_rings, static_cast<float> (radius * radius), candidates);
+  }
+
+  size_t num_found = candidates.size ();
+  if (max_nn > 0 && num_found > max_nn)
+  {
+    num_found = max_nn;
+    std::partial_sort (candidates.begin (), candidates.begin () + num_found, candidates.end ());
+  }
+  else if (sorted_results_)
+  {
+    std::sort (candidates.begin (), candidates.end ());
+  }
+  k_indices.resize (num_found);
+  k_sqr_distances.resize (num_found);
+  for (size_t i = 0; i < num_found; ++i)
+  {
+    k_sqr_distances[i] = candidates[i].first;
+    k_indices[i] = candidates[i].second;
+  }
+  return (static_cast<int> (num_found));
+}
+
+template <typename PointT> void
+pcl::graph::ApproximateGridSearch<PointT>::getCellCoordinates (const PointT& point, int64_t coordinates[3]) const
+{
+  const Eigen::Vector3f c = (point.getVector3fMap () - grid_origin_) / grid_cell_size_;
+  for (size_t i = 0; i < 3; ++i)
+    coordinates[i] = static_cast<int64_t> (std::floor (c[i]));
+}
+
+template <typename PointT> void
+pcl::graph::ApproximateGridSearch<PointT>::collectCandidates (const PointT& point,
+                                                              unsigned int num_rings,
+                                                              float max_sqr_distance,
+                                                              std::vector<std::pair<float, int> >& candidates) const
+{
+  int64_t c[3];
+  getCellCoordinates (point, c);
+  const int64_t r = num_rings;
+  const Eigen::Vector3f q = point.getVector3fMap ();
+
+  // Clip the cube of cells around the query point to the grid
+  int64_t lo[3], hi[3];
+  uint64_t num_cube_cells = 1;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    lo[i] = std::max<int64_t> (c[i] - r, 0);
+    hi[i] = std::min<int64_t> (c[i] + r, grid_max_[i]);
+    if (lo[i] > hi[i])
+      return;
+    num_cube_cells *= hi[i] - lo[i] + 1;
+  }
+
+  // If the cube is larger than the number of occupied cells, most of its
+  // cells are empty, so it is cheaper to check the occupied cells instead
+  if (num_cube_cells > cell_keys_.size ())
+  {
+    for (size_t cell = 0; cell < cell_keys_.size (); ++cell)
+    {
+      uint32_t x, y, z;
+      unpackVoxelKey (cell_keys_[cell], x, y, z);
+      if (x >= lo[0] && x <= hi[0] && y >= lo[1] && y <= hi[1] && z >= lo[2] && z <= hi[2])
+        collectCellCandidates (cell, q, max_sqr_distance, candidates);
+    }
+    return;
+  }
+
+  for (int64_t x = lo[0]; x <= hi[0]; ++x)
+    for (int64_t y = lo[1]; y <= hi[1]; ++y)
+      for (int64_t z = lo[2]; z <= hi[2]; ++z)
+      {
+        size_t cell;
+        if (table_.find (packVoxelKey (x, y, z), cell))
+          collectCellCandidates (cell, q, max_sqr_distance, candidates);
+      }
+}
+
+template <typename PointT> void
+pcl::graph::ApproximateGridSearch<PointT>::collectCellCandidates (size_t cell,
+                                                                  const Eigen::Vector3f& query,
+                                                                  float max_sqr_distance,
+                                                                  std::vector<std::pair<float, int> >& candidates) const
+{
+  for (size_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i)
+  {
+    const int index = cell_points_[i];
+    const float d = (input_->operator[] (index).getVector3fMap () - query).squaredNorm ();
+    if (d <= max_sqr_distance)
+      candidates.push_back (std::make_pair (d, index));
+  }
+}
+
+template <typename PointT> float
+pcl::graph::ApproximateGridSearch<PointT>::estimateCellSize (const std::vector<int>& points) const
+{
+  if (points.empty ())
+    return (1.0f);
+
+  Eigen::Vector3f min_pt = Eigen::Vector3f::Constant (std::numeric_limits<float>::max ());
+  Eigen::Vector3f max_pt = Eigen::Vector3f::Constant (-std::numeric_limits<float>::max ());
+  for (size_t i = 0; i < points.size (); ++i)
+  {
+    const Eigen::Vector3f p = input_->operator[] (points[i]).getVector3fMap ();
+    min_pt = min_pt.cwiseMin (p);
+    max_pt = max_pt.cwiseMax (p);
+  }
+  const float diagonal = (max_pt - min_pt).norm ();
+  if (diagonal == 0.0f)
+    return (1.0f);
+
+  // Start with the cell size that would be right if the points filled the
+  // bounding box uniformly, then refine it by counting occupied cells. Real
+  // data are mostly surfaces, where the cell occupancy grows quadratically
+  // with the cell size; the refinement step assumes this.
+  const float target = std::max (points_per_cell_, 1u);
+  const float min_size = (max_pt - min_pt).maxCoeff () / (MAX_VOXEL_KEY - 2);
+  float size = std::max (diagonal * std::pow (target / points.size (), 1.0f / 3.0f), min_size);
+  for (size_t iteration = 0; iteration < 8; ++iteration)
+  {
+    VoxelHashTable cells (points.size ());
+    for (size_t i = 0; i < points.size (); ++i)
+    {
+      const Eigen::Vector3f c = (input_->operator[] (points[i]).getVector3fMap () - min_pt) / size;
+      cells.insert (packVoxelKey (c[0], c[1], c[2]), 0);
+    }
+    const float occupancy = static_cast<float> (points.size ()) / cells.size ();
+    const float ratio = target / occupancy;
+    if (ratio > 0.8f && ratio < 1.25f)
+      break;
+    size = std::max (size * std::min (std::max (std::sqrt (ratio), 0.25f), 4.0f), min_size);
+  }
+  return (size);
+}
+
+#endif /* PCL_GRAPH_IMPL_APPROXIMATE_GRID_SEARCH_HPP */
+
@@ -0,0 +1,287 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_CELL_LIST_GRAPH_BUILDER_HPP
+#define PCL_GRAPH_IMPL_CELL_LIST_GRAPH_BUILDER_HPP
+
+#include <cmath>
+#include <algorithm>
+
+#include <pcl/common/io.h>
+#include <pcl/common/point_tests.h>
+#include <pcl/console/print.h>
+
+#include "graph/utils.h"
+#include "graph/voxel_hash.h"
+#include "graph/arena_allocator.h"
+#include "graph/cell_list_graph_builder.h"
+
+template <typename PointT, typename GraphT> void
+pcl::graph::CellListGraphBuilder<PointT, GraphT>::compute (GraphT& graph)
+{
+  if (!initCompute ())
+  {
+    graph = GraphT ();
+    deinitCompute ();
+    return;
+  }
+
+  if (!(radius_ > 0.0f))
+  {
+    PCL_ERROR ("[pcl::graph::CellListGraphBuilder::compute] Radius should be positive.\n");
+    graph = GraphT ();
+    point_to_vertex_map_.clear ();
+    deinitCompute ();
+    return;
+  }
+
+  typedef std::pair<VertexId, VertexId> VertexPair;
+
+  std::vector<int> points;
+  points.reserve (indices_->size ());
+  for (size_t i = 0; i < indices_->size (); ++i)
+    if (pcl::isFinite (input_->operator[] (indices_->operator[] (i))))
+      points.push_back (indices_->operator[] (i));
+  const size_t num_points = points.size ();
+
+  // Compute grid cells of the points. The cell size is the radius, unless
+  // the grid coordinates would not fit in packed keys.
+  Eigen::Vector3f min_pt = Eigen::Vector3f::Constant (std::numeric_limits<float>::max ());
+  Eigen::Vector3f max_pt = Eigen::Vector3f::Constant (-std::numeric_limits<float>::max ());
+  for (size_t i = 0; i < num_points; ++i)
+  {
+    const Eigen::Vector3f p = input_->operator[] (points[i]).getVector3fMap ();
+    min_pt = min_pt.cwiseMin (p);
+    max_pt = max_pt.cwiseMax (p);
+  }
+  float cell_size = radius_;
+  if (num_points)
+    cell_size = std::max (cell_size, (max_pt - min_pt).maxCoeff () / (MAX_VOXEL_KEY - 2));
+
+  // Bucket the points into cells (counting sort). Cell ids are assigned in
+  // the order of first appearance.
+  VoxelHashTable table (num_points);
+  std::vector<uint64_t> cell_keys;
+  std::vector<size_t> point_cell (num_points);
+  std::vector<size_t> cell_offsets (1, 0);
+  for (size_t i = 0; i < num_points; ++i)
+  {
+    const Eigen::Vector3f c = (input_->operator[] (points[i]).getVector3fMap () - min_pt) / cell_size;
+    const uint64_t key = packVoxelKey (c[0], c[1], c[2]);
+    size_t cell;
+    if (!table.find (key, cell))
+    {
+      cell = cell_keys.size ();
+      table.insert (key, cell);
+      cell_keys.push_back (key);
+      cell_offsets.push_back (0);
+    }
+    point_cell[i] = cell;
+    ++cell_offsets[cell + 1];
+  }
+  const size_t num_cells = cell_keys.size ();
+  for (size_t i = 0; i < num_cells; ++i)
+    cell_offsets[i + 1] += cell_offsets[i];
+
+  // Coordinates of the points (structure-of-arrays) and their vertex ids in
+  // cell order, so that the points of a cell are contiguous in memory
+  std::vector<float> xs (num_points), ys (num_points), zs (num_points);
+  std::vector<VertexId> ids (num_points);
+  {
+    std::vector<size_t> next (cell_offsets.begin (), cell_offsets.end () - 1);
+    for (size_t i = 0; i < num_points; ++i)
+    {
+      const size_t j = next[point_cell[i]]++;
+      const PointInT& p = input_->operator[] (points[i]);
+      xs[j] = p.x;
+      ys[j] = p.y;
+      zs[j] = p.z;
+      ids[j] = i;
+    }
+  }
+
+  // Sweep the cells in parallel. Each chunk of cells compares the points of
+  // every cell among themselves and with the points in the "forward" half of
+  // the neighboring cells. Candidate pairs within the radius are stored along
+  // with their squared distances.
+  const float sqr_radius = radius_ * radius_;
+  const int num_chunks = detail::getMaxNumberOfThreads ();
+  std::vector<std::vector<VertexPair> > chunk_pairs (num_chunks);
+  std::vector<std::vector<float> > chunk_distances (num_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static, 1)
+#endif
+  for (int chunk = 0; chunk < num_chunks; ++chunk)
+  {
+    const std::pair<size_t, size_t> range = detail::getChunkRange (chunk, num_chunks, num_cells);
+    std::vector<VertexPair>& pairs = chunk_pairs[chunk];
+    std::vector<float>& distances = chunk_distances[chunk];
+    for (size_t cell = range.first; cell < range.second; ++cell)
+    {
+      uint32_t x, y, z;
+      unpackVoxelKey (cell_keys[cell], x, y, z);
+      for (size_t s = 0; s < 14; ++s)
+      {
+        // The first "offset" is the cell itself
+        size_t neighbor = cell;
+        if (s > 0)
+        {
+          const uint32_t nx = x + HALF_STENCIL[s - 1][0];
+          const uint32_t ny = y + HALF_STENCIL[s - 1][1];
+          const uint32_t nz = z + HALF_STENCIL[s - 1][2];
+          // Negative coordinates wrap around and are caught here as well
+          if (nx >= MAX_VOXEL_KEY || ny >= MAX_VOXEL_KEY || nz >= MAX_VOXEL_KEY)
+            continue;
+          if (!table.find (packVoxelKey (nx, ny, nz), neighbor))
+            continue;
+        }
+        for (size_t i = cell_offsets[cell]; i < cell_offsets[cell + 1]; ++i)
+        {
+          const size_t begin = neighbor == cell ? i + 1 : cell_offsets[neighbor];
+          for (size_t j = begin; j < cell_offsets[neighbor + 1]; ++j)
+          {
+            const float dx = xs[i] - xs[j];
+            const float dy = ys[i] - ys[j];
+            const float dz = zs[i] - zs[j];
+            const float d = dx * dx + dy * dy + dz * dz;
+            if (d <= sqr_radius)
+            {
+              pairs.push_back (std::make_pair (std::min (ids[i], ids[j]), std::max (ids[i], ids[j])));
+              distances.push_back (d);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<VertexPair> edges;
+  if (num_neighbors_ == 0)
+  {
+    // Every candidate pair is an edge, and each was found exactly once
+    size_t num_pairs = 0;
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+      num_pairs += chunk_pairs[chunk].size ();
+    edges.reserve (num_pairs);
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+    {
+      edges.insert (edges.end (), chunk_pairs[chunk].begin (), chunk_pairs[chunk].end ());
+      std::vector<VertexPair> ().swap (chunk_pairs[chunk]);
+    }
+  }
+  else
+  {
+    // Group the candidates by point (each candidate pair goes to both of its
+    // points) with a counting sort, then let every point keep its nearest
+    // neighbors
+    std::vector<size_t> offsets (num_points + 1, 0);
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+      for (size_t i = 0; i < chunk_pairs[chunk].size (); ++i)
+      {
+        ++offsets[chunk_pairs[chunk][i].first + 1];
+        ++offsets[chunk_pairs[chunk][i].second + 1];
+      }
+    for (size_t i = 0; i < num_points; ++i)
+      offsets[i + 1] += offsets[i];
+    std::vector<std::pair<float, VertexId> > candidates (offsets[num_points]);
+    {
+      std::vector<size_t> next (offsets.begin (), offsets.end () - 1);
+      for (int chunk = 0; chunk < num_chunks; ++chunk)
+      {
+        for (size_t i = 0; i < chunk_pairs[chunk].size (); ++i)
+        {
+          const VertexPair& p = chunk_pairs[chunk][i];
+          const float d = chunk_distances[chunk][i];
+          candidates[next[p.first]++] = std::make_pair (d, p.second);
+          candidates[next[p.second]++] = std::make_pair (d, p.first);
+        }
+        std::vector<VertexPair> ().swap (chunk_pairs[chunk]);
+        std::vector<float> ().swap (chunk_distances[chunk]);
+      }
+    }
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static, 1)
+#endif
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+    {
+      const std::pair<size_t, size_t> range = detail::getChunkRange (chunk, num_chunks, num_points);
+      std::vector<VertexPair>& pairs = chunk_pairs[chunk];
+      for (size_t i = range.first; i < range.second; ++i)
+      {
+        const typename std::vector<std::pair<float, VertexId> >::iterator begin = candidates.begin () + offsets[i];
+        const typename std::vector<std::pair<float, VertexId> >::iterator end = candidates.begin () + offsets[i + 1];
+        const typename std::vector<std::pair<float, VertexId> >::iterator middle = begin + std::min<size_t> (num_neighbors_, end - begin);
+        std::nth_element (begin, middle, end);
+        for (typename std::vector<std::pair<float, VertexId> >::iterator it = begin; it != middle; ++it)
+          pairs.push_back (std::make_pair (std::min<VertexId> (i, it->second), std::max<VertexId> (i, it->second)));
+      }
+    }
+    size_t num_pairs = 0;
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+      num_pairs += chunk_pairs[chunk].size ();
+    edges.reserve (num_pairs);
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+    {
+      edges.insert (edges.end (), chunk_pairs[chunk].begin (), chunk_pairs[chunk].end ());
+      std::vector<VertexPair> ().swap (chunk_pairs[chunk]);
+    }
+    // An edge is found from both ends if the points are among the nearest
+    // neighbors of each other
+    std::sort (edges.begin (), edges.end ());
+    edges.erase (std::unique (edges.begin (), edges.end ()), edges.end ());
+  }
+
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (edges.size ()))));
+
+  typename pcl::PointCloud<PointOutT>::Ptr cloud (new pcl::PointCloud<PointOutT>);
+  pcl::copyPointCloud (*input_, points, *cloud);
+  graph = GraphT (cloud);
+  bindEdgeListToCurrentArena (graph);
+  for (size_t i = 0; i < edges.size (); ++i)
+    boost::add_edge (edges[i].first, edges[i].second, graph);
+
+  point_to_vertex_map_.clear ();
+  point_to_vertex_map_.resize (input_->size (), std::numeric_limits<VertexId>::max ());
+  for (size_t i = 0; i < num_points; ++i)
+    point_to_vertex_map_[points[i]] = i;
+
+  this->applyVertexOrdering (graph);
+  deinitCompute ();
+}
+
+#endif /* PCL_GRAPH_IMPL_CELL_LIST_GRAPH_BUILDER_HPP */
+
@@ -0,0 +1,235 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_COARSENING_HPP
+#define PCL_GRAPH_IMPL_COARSENING_HPP
+
+#include <limits>
+#include <algorithm>
+
+#include <pcl/point_cloud.h>
+
+#include "graph/coarsening.h"
+#include "graph/arena_allocator.h"
+#include "impl/octree_pointcloud_adjacency_container2.hpp"
+
+template <typename Graph> size_t
+pcl::graph::coarsenGraph (const Graph& fine,
+                          Graph& coarse,
+                          std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& fine_to_coarse)
+{
+  BOOST_CONCEPT_ASSERT ((pcl::graph::PointCloudGraphConcept<Graph>));
+
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+  typedef typename boost::graph_traits<Graph>::edge_descriptor EdgeId;
+  typedef typename boost::graph_traits<Graph>::edge_iterator EdgeIterator;
+  typedef typename boost::graph_traits<Graph>::out_edge_iterator OutEdgeIterator;
+  typedef typename point_cloud_graph_traits<Graph>::point_type PointT;
+  typedef typename point_cloud_graph_traits<Graph>::point_cloud_type PointCloud;
+  typedef typename boost::property_map<Graph, boost::edge_weight_t>::const_type EdgeWeightMap;
+  typedef typename boost::property_traits<EdgeWeightMap>::value_type Weight;
+
+  struct Edge
+  {
+    VertexId source;
+    VertexId target;
+    Weight weight;
+    bool operator< (const Edge& other) const
+    {
+      return (source < other.source || (source == other.source && target < other.target));
+    }
+  };
+
+  const size_t num_vertices = boost::num_vertices (fine);
+  const VertexId nil = std::numeric_limits<VertexId>::max ();
+  EdgeWeightMap weights = boost::get (boost::edge_weight, fine);
+
+  // Step 1: heavy-edge matching.
+  std::vector<VertexId> mate (num_vertices, nil);
+  fine_to_coarse.assign (num_vertices, nil);
+  size_t num_coarse = 0;
+  for (VertexId v = 0; v < num_vertices; ++v)
+  {
+    if (fine_to_coarse[v] != nil)
+      continue;
+    VertexId best = nil;
+    Weight best_weight = -std::numeric_limits<Weight>::max ();
+    OutEdgeIterator ei, ee;
+    for (boost::tie (ei, ee) = boost::out_edges (v, fine); ei != ee; ++ei)
+    {
+      VertexId u = boost::target (*ei, fine);
+      if (u != v && fine_to_coarse[u] == nil && weights[*ei] > best_weight)
+      {
+        best = u;
+        best_weight = weights[*ei];
+      }
+    }
+    fine_to_coarse[v] = num_coarse;
+    if (best != nil)
+    {
+      fine_to_coarse[best] = num_coarse;
+      mate[v] = best;
+    }
+    ++num_coarse;
+  }
+
+  // Step 2: aggregate points.
+  typename PointCloud::ConstPtr fine_cloud = pcl::graph::point_cloud (fine);
+  typename PointCloud::Ptr cloud (new PointCloud);
+  cloud->header = fine_cloud->header;
+  cloud->points.resize (num_coarse);
+  cloud->width = num_coarse;
+  cloud->height = 1;
+  for (VertexId v = 0, next = 0; v < num_vertices; ++v)
+  {
+    // Each aggregate is processed once, from the vertex that initiated the
+    // match (initiators got consecutive coarse ids in step 1)
+    const VertexId c = fine_to_coarse[v];
+    if (c != next)
+      continue;
+    ++next;
+    pcl::octree::AveragePoint<PointT> average;
+    average.add (fine_cloud->points[v]);
+    if (mate[v] != nil)
+      average.add (fine_cloud->points[mate[v]]);
+    average.compute ();
+    cloud->points[c] = average;
+  }
+
+  // Step 3: collect coarse edges, merge parallel ones summing their weights.
+  std::vector<Edge> edges;
+  edges.reserve (boost::num_edges (fine));
+  EdgeIterator ei, ee;
+  for (boost::tie (ei, ee) = boost::edges (fine); ei != ee; ++ei)
+  {
+    VertexId s = fine_to_coarse[boost::source (*ei, fine)];
+    VertexId t = fine_to_coarse[boost::target (*ei, fine)];
+    if (s == t)
+      continue;
+    Edge edge = { std::min (s, t), std::max (s, t), weights[*ei] };
+    edges.push_back (edge);
+  }
+  std::sort (edges.begin (), edges.end ());
+  size_t num_merged = 0;
+  for (size_t i = 0; i < edges.size (); ++i)
+  {
+    if (num_merged && edges[num_merged - 1].source == edges[i].source && edges[num_merged - 1].target == edges[i].target)
+      edges[num_merged - 1].weight += edges[i].weight;
+    else
+      edges[num_merged++] = edges[i];
+  }
+  edges.resize (num_merged);
+
+  // Step 4: build the coarse graph.
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (edges.size ()))));
+  coarse = Graph (cloud);
+  bindEdgeListToCurrentArena (coarse);
+  for (size_t i = 0; i < edges.size (); ++i)
+  {
+    EdgeId e = boost::add_edge (edges[i].source, edges[i].target, coarse).first;
+    boost::put (boost::edge_weight, coarse, e, edges[i].weight);
+  }
+
+  return (num_coarse);
+}
+
+template <typename GraphT> void
+pcl::graph::GraphHierarchy<GraphT>::compute (const GraphPtr& graph)
+{
+  typedef typename point_cloud_graph_traits<GraphT>::point_type PointT;
+  typedef typename point_cloud_graph_traits<GraphT>::point_cloud_type PointCloud;
+  typedef pcl::octree::AveragePoint<PointT> AveragePoint;
+  typedef std::vector<AveragePoint, Eigen::aligned_allocator<AveragePoint> > AveragePointVector;
+
+  levels_.assign (1, graph);
+  fine_to_coarse_.clear ();
+
+  // Mapping between the vertices of the input graph and the current level
+  typename PointCloud::ConstPtr input_cloud = pcl::graph::point_cloud (*graph);
+  std::vector<VertexId> input_to_level (boost::num_vertices (*graph));
+  for (size_t i = 0; i < input_to_level.size (); ++i)
+    input_to_level[i] = i;
+
+  while (levels_.size () < max_num_levels_)
+  {
+    const GraphT& fine = *levels_.back ();
+    const size_t num_fine = boost::num_vertices (fine);
+    if (num_fine < min_num_vertices_)
+      break;
+    GraphPtr coarse (new GraphT);
+    std::vector<VertexId> fine_to_coarse;
+    const size_t num_coarse = coarsenGraph (fine, *coarse, fine_to_coarse);
+    if (num_coarse > num_fine * (1.0f - min_reduction_))
+      break;
+
+    // coarsenGraph() averages the points of matched vertex pairs, which is
+    // only exact on the first level. Recompute the points of the coarse
+    // vertices as the average of all input points they aggregate.
+    AveragePointVector averages (num_coarse);
+    for (size_t i = 0; i < input_to_level.size (); ++i)
+    {
+      input_to_level[i] = fine_to_coarse[input_to_level[i]];
+      averages[input_to_level[i]].add (input_cloud->points[i]);
+    }
+    typename PointCloud::Ptr coarse_cloud = pcl::graph::point_cloud (*coarse);
+    for (size_t i = 0; i < num_coarse; ++i)
+    {
+      averages[i].compute ();
+      coarse_cloud->points[i] = averages[i];
+    }
+
+    levels_.push_back (coarse);
+    fine_to_coarse_.push_back (std::vector<VertexId> ());
+    fine_to_coarse_.back ().swap (fine_to_coarse);
+  }
+}
+
+template <typename GraphT>
+template <typename T> void
+pcl::graph::GraphHierarchy<GraphT>::prolongate (size_t level,
+                                                const std::vector<T>& coarse_data,
+                                                std::vector<T>& fine_data) const
+{
+  assert (level > 0 && level < levels_.size ());
+  const std::vector<VertexId>& fine_to_coarse = fine_to_coarse_.at (level - 1);
+  std::vector<T> data (fine_to_coarse.size ());
+  for (size_t i = 0; i < fine_to_coarse.size (); ++i)
+    data[i] = coarse_data[fine_to_coarse[i]];
+  fine_data.swap (data);
+}
+
+#endif /* PCL_GRAPH_IMPL_COARSENING_HPP */
@@ -0,0 +1,84 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_COMPACT_HPP
+#define PCL_GRAPH_IMPL_COMPACT_HPP
+
+#include <limits>
+
+#include "graph/compact.h"
+#include "graph/reorder.h"
+
+template <typename Graph, typename Predicate>
+std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>
+pcl::graph::compactGraph (Graph& graph, Predicate keep)
+{
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+
+  const size_t num_vertices = boost::num_vertices (graph);
+  const VertexId nil = std::numeric_limits<VertexId>::max ();
+
+  std::vector<VertexId> new_id (num_vertices, nil);
+  size_t num_kept = 0;
+  for (VertexId v = 0; v < num_vertices; ++v)
+    if (keep (v))
+      new_id[v] = num_kept++;
+
+  if (num_kept != num_vertices)
+    detail::relabelVertices (graph, new_id, num_kept);
+
+  return (new_id);
+}
+
+template <typename Graph, typename Predicate>
+std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>
+pcl::graph::compactGraph (Graph& graph,
+                          Predicate keep,
+                          std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& point_to_vertex_map)
+{
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+
+  std::vector<VertexId> new_id = compactGraph (graph, keep);
+
+  for (size_t i = 0; i < point_to_vertex_map.size (); ++i)
+    if (point_to_vertex_map[i] < new_id.size ())
+      point_to_vertex_map[i] = new_id[point_to_vertex_map[i]];
+
+  return (new_id);
+}
+
+#endif /* PCL_GRAPH_IMPL_COMPACT_HPP */
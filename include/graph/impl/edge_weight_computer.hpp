@@ -187,5 +187,24 @@ pcl::graph::EdgeWeightComputer<GraphT>::compute (GraphT& graph, EdgeWeightMap we
   }
 }
 
+template <typename GraphT> pcl::graph::MemoryReport
+pcl::graph::EdgeWeightComputer<GraphT>::getMemoryUsage () const
+{
+  using namespace detail;
+  MemoryReport report;
+  for (size_t i = 0; i < g_terms_.size (); ++i)
+    report.add (boost::str (boost::format ("global term %zu/edge weights") % i),
+                containerBytes (g_terms_[i].edge_weights_));
+  for (size_t i = 0; i < l_terms_.size (); ++i)
+  {
+    report.add (boost::str (boost::format ("local term %zu/edge weights") % i),
+                containerBytes (l_terms_[i].edge_weights_));
+    report.add (boost::str (boost::format ("local term %zu/vertex sums") % i),
+                containerBytes (l_terms_[i].vertex_sums_)
+              + containerBytes (l_terms_[i].vertex_degrees_));
+  }
+  return (report);
+}
+
 #endif /* PCL_GRAPH_IMPL_EDGE_WEIGHT_COMPUTER_HPP */
 
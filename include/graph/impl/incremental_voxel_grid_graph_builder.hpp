@@ -0,0 +1,332 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_INCREMENTAL_VOXEL_GRID_GRAPH_BUILDER_HPP
+#define PCL_GRAPH_IMPL_INCREMENTAL_VOXEL_GRID_GRAPH_BUILDER_HPP
+
+#include <cmath>
+#include <cstring>
+
+#include <pcl/common/centroid.h>
+
+#include "graph/voxel_grid_graph_builder.h"
+#include "graph/incremental_voxel_grid_graph_builder.h"
+
+template <typename PointT, typename GraphT> void
+pcl::graph::IncrementalVoxelGridGraphBuilder<PointT, GraphT>::compute (GraphT& graph)
+{
+  if (!initCompute ())
+  {
+    reset ();
+    graph = GraphT ();
+    deinitCompute ();
+    return;
+  }
+
+  const size_t NIL = std::numeric_limits<size_t>::max ();
+  const VertexId nil = std::numeric_limits<VertexId>::max ();
+
+  // The state kept from the previous frame can only be reused if it was
+  // built for the same graph, cloud size, and parameters.
+  const bool incremental = graph_ == &graph &&
+                           boost::num_vertices (graph) == num_vertices_ &&
+                           boost::num_edges (graph) == num_edges_ &&
+                           previous_.size () == input_->size () &&
+                           state_resolution_ == voxel_resolution_ &&
+                           state_use_transform_ == use_transform_;
+  if (!incremental)
+  {
+    reset ();
+    graph = GraphT ();
+    point_voxels_.assign (input_->size (), NIL);
+    state_resolution_ = voxel_resolution_;
+    state_use_transform_ = use_transform_;
+  }
+
+  std::vector<uint8_t> selected (input_->size (), fake_indices_ ? 1 : 0);
+  if (!fake_indices_)
+    for (size_t i = 0; i < indices_->size (); ++i)
+      selected[indices_->operator[] (i)] = 1;
+
+  pcl::PointCloud<pcl::PointXYZ> transformed;
+  detail::transformPoints (*input_, use_transform_, transformed);
+
+  // Step 1: move the points that changed since the previous frame between
+  // voxels and collect the voxels that had points inserted or removed.
+  std::vector<size_t> dirty_voxels;
+  std::vector<uint8_t> voxel_dirty (voxels_.size (), 0);
+  for (size_t i = 0; i < input_->size (); ++i)
+  {
+    const size_t old_voxel = point_voxels_[i];
+    uint64_t key;
+    const pcl::PointXYZ& p = transformed[i];
+    if (!selected[i] || !computeAnchoredVoxelKey (p.x, p.y, p.z, voxel_resolution_, key))
+      key = std::numeric_limits<uint64_t>::max ();
+
+    const bool valid = key != std::numeric_limits<uint64_t>::max ();
+    if (old_voxel == NIL && !valid)
+      continue;
+    if (old_voxel != NIL && valid && voxels_[old_voxel].key == key &&
+        std::memcmp (&previous_[i], &input_->operator[] (i), sizeof (PointInT)) == 0)
+      continue;
+
+    if (old_voxel != NIL)
+    {
+      --voxels_[old_voxel].num_points;
+      if (!voxel_dirty[old_voxel])
+      {
+        voxel_dirty[old_voxel] = 1;
+        dirty_voxels.push_back (old_voxel);
+      }
+    }
+    point_voxels_[i] = NIL;
+    if (valid)
+    {
+      const size_t voxel = findOrCreateVoxel (key);
+      if (voxel_dirty.size () < voxels_.size ())
+        voxel_dirty.resize (voxels_.size (), 0);
+      ++voxels_[voxel].num_points;
+      if (!voxel_dirty[voxel])
+      {
+        voxel_dirty[voxel] = 1;
+        dirty_voxels.push_back (voxel);
+      }
+      point_voxels_[i] = voxel;
+    }
+  }
+
+  // Step 2: release the vertices of the voxels that became empty. This is
+  // done before assigning vertices to new voxels, so that the released
+  // vertices (cleared of their edges) can be reused right away.
+  std::vector<uint8_t> vertex_released (boost::num_vertices (graph), 0);
+  for (size_t i = 0; i < dirty_voxels.size (); ++i)
+  {
+    Voxel& voxel = voxels_[dirty_voxels[i]];
+    if (voxel.num_points > 0 || voxel.vertex == nil)
+      continue;
+    std::vector<EdgeId> edges;
+    typename boost::graph_traits<GraphT>::out_edge_iterator ei, ee;
+    for (boost::tie (ei, ee) = boost::out_edges (voxel.vertex, graph); ei != ee; ++ei)
+      edges.push_back (*ei);
+    for (size_t j = 0; j < edges.size (); ++j)
+      boost::remove_edge (edges[j], graph);
+    free_vertices_.push_back (voxel.vertex);
+    vertex_released[voxel.vertex] = 1;
+    voxel.vertex = nil;
+  }
+
+  // Step 3: assign vertices to the voxels that became occupied.
+  std::vector<uint8_t> voxel_new (voxels_.size (), 0);
+  for (size_t i = 0; i < dirty_voxels.size (); ++i)
+  {
+    Voxel& voxel = voxels_[dirty_voxels[i]];
+    if (voxel.num_points == 0 || voxel.vertex != nil)
+      continue;
+    if (free_vertices_.empty ())
+    {
+      voxel.vertex = boost::add_vertex (graph);
+    }
+    else
+    {
+      voxel.vertex = free_vertices_.back ();
+      free_vertices_.pop_back ();
+      if (voxel.vertex < vertex_released.size ())
+        vertex_released[voxel.vertex] = 0;
+    }
+    voxel_new[dirty_voxels[i]] = 1;
+  }
+
+  removed_vertices_.clear ();
+  for (size_t v = 0; v < vertex_released.size (); ++v)
+    if (vertex_released[v])
+      removed_vertices_.push_back (v);
+
+  // Step 4: recompute the centroids of the dirty voxels. All points are
+  // visited, but only those in dirty voxels are accumulated.
+  std::vector<size_t> centroid_slot (voxels_.size (), NIL);
+  size_t num_centroids = 0;
+  for (size_t i = 0; i < dirty_voxels.size (); ++i)
+    if (voxels_[dirty_voxels[i]].num_points > 0)
+      centroid_slot[dirty_voxels[i]] = num_centroids++;
+  {
+    std::vector<pcl::CentroidPoint<PointInT> > centroids (num_centroids);
+    for (size_t i = 0; i < input_->size (); ++i)
+      if (point_voxels_[i] != NIL && centroid_slot[point_voxels_[i]] != NIL)
+        centroids[centroid_slot[point_voxels_[i]]].add (input_->operator[] (i));
+    for (size_t i = 0; i < dirty_voxels.size (); ++i)
+      if (centroid_slot[dirty_voxels[i]] != NIL)
+        centroids[centroid_slot[dirty_voxels[i]]].get (graph[voxels_[dirty_voxels[i]].vertex]);
+  }
+
+  // Step 5: connect the new voxels with their occupied neighbors. A pair of
+  // new voxels is connected only when visited in the forward direction of
+  // the half stencil, so that no edge is added twice.
+  for (size_t i = 0; i < dirty_voxels.size (); ++i)
+  {
+    if (!voxel_new[dirty_voxels[i]])
+      continue;
+    const Voxel& voxel = voxels_[dirty_voxels[i]];
+    uint32_t x, y, z;
+    unpackVoxelKey (voxel.key, x, y, z);
+    for (size_t j = 0; j < 13; ++j)
+    {
+      for (int sign = 1; sign >= -1; sign -= 2)
+      {
+        const uint32_t nx = x + sign * HALF_STENCIL[j][0];
+        const uint32_t ny = y + sign * HALF_STENCIL[j][1];
+        const uint32_t nz = z + sign * HALF_STENCIL[j][2];
+        // Negative coordinates wrap around and are caught here as well
+        if (nx >= MAX_VOXEL_KEY || ny >= MAX_VOXEL_KEY || nz >= MAX_VOXEL_KEY)
+          continue;
+        size_t neighbor;
+        if (!voxel_table_.find (packVoxelKey (nx, ny, nz), neighbor) || voxels_[neighbor].vertex == nil)
+          continue;
+        if (voxel_new[neighbor] && sign < 0)
+          continue;
+        boost::add_edge (voxel.vertex, voxels_[neighbor].vertex, graph);
+      }
+    }
+  }
+
+  // Step 6: report dirty vertices and edges. Each edge incident to a dirty
+  // vertex is reported once (from its smaller dirty endpoint).
+  std::vector<uint8_t> vertex_dirty (boost::num_vertices (graph), 0);
+  for (size_t i = 0; i < dirty_voxels.size (); ++i)
+    if (voxels_[dirty_voxels[i]].vertex != nil)
+      vertex_dirty[voxels_[dirty_voxels[i]].vertex] = 1;
+  dirty_vertices_.clear ();
+  dirty_edges_.clear ();
+  for (VertexId v = 0; v < vertex_dirty.size (); ++v)
+  {
+    if (!vertex_dirty[v])
+      continue;
+    dirty_vertices_.push_back (v);
+    typename boost::graph_traits<GraphT>::out_edge_iterator ei, ee;
+    for (boost::tie (ei, ee) = boost::out_edges (v, graph); ei != ee; ++ei)
+    {
+      const VertexId u = boost::target (*ei, graph);
+      if (!vertex_dirty[u] || u > v)
+        dirty_edges_.push_back (*ei);
+    }
+  }
+
+  point_to_vertex_map_.resize (input_->size ());
+  for (size_t i = 0; i < input_->size (); ++i)
+    point_to_vertex_map_[i] = point_voxels_[i] == NIL ? nil : voxels_[point_voxels_[i]].vertex;
+  this->computeVertexToPointsMap (boost::num_vertices (graph));
+
+  // Drop empty voxels if they make up the majority of the table.
+  size_t num_occupied = 0;
+  for (size_t i = 0; i < voxels_.size (); ++i)
+    if (voxels_[i].num_points > 0)
+      ++num_occupied;
+  if (voxels_.size () > 2 * num_occupied + 1024)
+    compactVoxels ();
+
+  previous_ = *input_;
+  graph_ = &graph;
+  num_vertices_ = boost::num_vertices (graph);
+  num_edges_ = boost::num_edges (graph);
+
+  deinitCompute ();
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::IncrementalVoxelGridGraphBuilder<PointT, GraphT>::reset ()
+{
+  state_resolution_ = 0.0f;
+  state_use_transform_ = use_transform_;
+  voxels_.clear ();
+  voxel_table_capacity_ = 1024;
+  voxel_table_ = VoxelHashTable (voxel_table_capacity_);
+  point_voxels_.clear ();
+  previous_.clear ();
+  graph_ = 0;
+  num_vertices_ = 0;
+  num_edges_ = 0;
+  free_vertices_.clear ();
+  dirty_vertices_.clear ();
+  removed_vertices_.clear ();
+  dirty_edges_.clear ();
+}
+
+template <typename PointT, typename GraphT> size_t
+pcl::graph::IncrementalVoxelGridGraphBuilder<PointT, GraphT>::findOrCreateVoxel (uint64_t key)
+{
+  size_t voxel;
+  if (voxel_table_.find (key, voxel))
+    return (voxel);
+  if (voxels_.size () + 1 > voxel_table_capacity_)
+    rebuildVoxelTable (2 * voxel_table_capacity_);
+  Voxel v = { key, std::numeric_limits<VertexId>::max (), 0 };
+  voxels_.push_back (v);
+  voxel_table_.insert (key, voxels_.size () - 1);
+  return (voxels_.size () - 1);
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::IncrementalVoxelGridGraphBuilder<PointT, GraphT>::rebuildVoxelTable (size_t capacity)
+{
+  voxel_table_capacity_ = std::max (capacity, voxels_.size ());
+  voxel_table_ = VoxelHashTable (voxel_table_capacity_);
+  for (size_t i = 0; i < voxels_.size (); ++i)
+    voxel_table_.insert (voxels_[i].key, i);
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::IncrementalVoxelGridGraphBuilder<PointT, GraphT>::compactVoxels ()
+{
+  const size_t NIL = std::numeric_limits<size_t>::max ();
+  std::vector<size_t> new_index (voxels_.size (), NIL);
+  std::vector<Voxel> voxels;
+  voxels.reserve (voxels_.size ());
+  for (size_t i = 0; i < voxels_.size (); ++i)
+  {
+    if (voxels_[i].num_points == 0)
+      continue;
+    new_index[i] = voxels.size ();
+    voxels.push_back (voxels_[i]);
+  }
+  voxels_.swap (voxels);
+  for (size_t i = 0; i < point_voxels_.size (); ++i)
+    if (point_voxels_[i] != NIL)
+      point_voxels_[i] = new_index[point_voxels_[i]];
+  rebuildVoxelTable (2 * voxels_.size ());
+}
+
+#endif /* PCL_GRAPH_IMPL_INCREMENTAL_VOXEL_GRID_GRAPH_BUILDER_HPP */
+
@@ -0,0 +1,220 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_MEMORY_USAGE_HPP
+#define PCL_GRAPH_IMPL_MEMORY_USAGE_HPP
+
+#include <map>
+#include <set>
+#include <list>
+
+#include <boost/bimap.hpp>
+#include <boost/format.hpp>
+#include <boost/concept_check.hpp>
+
+#include <Eigen/Sparse>
+
+#include "graph/utils.h"
+#include "graph/memory_usage.h"
+#include "graph/arena_allocator.h"
+#include "graph/point_cloud_graph.h"
+#include "graph/point_cloud_graph_concept.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    namespace detail
+    {
+
+      /* The functions below estimate the amount of memory occupied by the
+       * elements of standard containers. For node-based containers the
+       * per-node overhead of the GNU implementation is assumed (two links
+       * for lists, three links and a color for red-black trees). */
+
+      template <typename T, typename A> inline size_t
+      containerBytes (const std::vector<T, A>& c)
+      {
+        return (c.capacity () * sizeof (T));
+      }
+
+      template <typename T, typename A> inline size_t
+      containerBytes (const std::list<T, A>& c)
+      {
+        return (c.size () * (sizeof (T) + 2 * sizeof (void*)));
+      }
+
+      template <typename T, typename C, typename A> inline size_t
+      containerBytes (const std::set<T, C, A>& c)
+      {
+        return (c.size () * (sizeof (T) + 4 * sizeof (void*)));
+      }
+
+      template <typename K, typename V, typename C, typename A> inline size_t
+      containerBytes (const std::map<K, V, C, A>& c)
+      {
+        return (c.size () * (sizeof (typename std::map<K, V, C, A>::value_type) + 4 * sizeof (void*)));
+      }
+
+      /** Each element of a bimap is stored once, and is linked into two
+        * ordered indices. */
+      template <typename L, typename R> inline size_t
+      containerBytes (const boost::bimap<L, R>& c)
+      {
+        return (c.size () * (sizeof (L) + sizeof (R) + 6 * sizeof (void*)));
+      }
+
+      template <typename Scalar, int Options, typename Index> inline size_t
+      matrixBytes (const Eigen::SparseMatrix<Scalar, Options, Index>& m)
+      {
+        return (m.nonZeros () * (sizeof (Scalar) + sizeof (Index)) + (m.outerSize () + 1) * sizeof (Index));
+      }
+
+      template <typename Derived> inline size_t
+      matrixBytes (const Eigen::PlainObjectBase<Derived>& m)
+      {
+        return (m.size () * sizeof (typename Derived::Scalar));
+      }
+
+      /** Get the number of bytes that were reserved in the arena that backs
+        * a container, but were not handed out (yet). Zero for containers
+        * that are not arena-backed. */
+      template <typename C> inline size_t
+      arenaSlackBytes (const C&)
+      {
+        return (0);
+      }
+
+      inline size_t
+      arenaSlackBytes (const MonotonicArena::Ptr& arena)
+      {
+        return (arena ? arena->getAllocatedBytes () - arena->getUsedBytes () : 0);
+      }
+
+      template <typename T> inline size_t
+      arenaSlackBytes (const std::vector<T, ArenaAllocator<T> >& c)
+      {
+        return (arenaSlackBytes (c.get_allocator ().arena ()));
+      }
+
+      template <typename T> inline size_t
+      arenaSlackBytes (const std::list<T, ArenaAllocator<T> >& c)
+      {
+        return (arenaSlackBytes (c.get_allocator ().arena ()));
+      }
+
+      /** Add entries for the point cloud and the adjacency structure of a
+        * plain (non-subgraph) point cloud graph to a memory report. */
+      template <typename Graph> void
+      addAdjacencyMemoryUsage (const Graph& graph, const std::string& prefix, MemoryReport& report)
+      {
+        size_t out_edges = 0;
+        for (size_t v = 0; v < graph.m_vertices.size (); ++v)
+          out_edges += containerBytes (graph.m_vertices[v].m_out_edges);
+        report.add (prefix + "points", containerBytes (pcl::graph::point_cloud (graph)->points));
+        report.add (prefix + "vertices", containerBytes (graph.m_vertices));
+        report.add (prefix + "out-edge lists", out_edges);
+        report.add (prefix + "edges", containerBytes (graph.m_edges));
+        // The out-edge vectors are allocated in the arena that was current
+        // when the graph was built, so look it up through them
+        const size_t slack = graph.m_vertices.empty () ? arenaSlackBytes (graph.m_edges)
+                                                       : arenaSlackBytes (graph.m_vertices[0].m_out_edges);
+        if (slack)
+          report.add (prefix + "arena (reserved, unused)", slack);
+      }
+
+      template <typename Graph, typename Enable = void>
+      struct memory_usage
+      {
+        void
+        operator () (const Graph& graph, MemoryReport& report) const
+        {
+          addAdjacencyMemoryUsage (graph, "", report);
+        }
+      };
+
+      template <typename Graph>
+      struct memory_usage<Graph, typename boost::enable_if<has_root_graph<Graph> >::type>
+      {
+        void
+        operator () (const Graph& graph, MemoryReport& report) const
+        {
+          addAdjacencyMemoryUsage (graph.m_graph, "", report);
+          addChildren (graph, "", report);
+        }
+
+        void
+        addChildren (const Graph& graph, const std::string& prefix, MemoryReport& report) const
+        {
+          typename Graph::const_children_iterator ci, ce;
+          size_t i = 0;
+          for (boost::tie (ci, ce) = graph.children (); ci != ce; ++ci, ++i)
+          {
+            const Graph& child = *ci;
+            std::string name = prefix + boost::str (boost::format ("subgraph %zu/") % i);
+            addAdjacencyMemoryUsage (child.m_graph, name, report);
+            report.add (name + "vertex mappings", sizeof (Graph)
+                                                + containerBytes (child.m_global_vertex)
+                                                + containerBytes (child.m_local_vertex));
+            report.add (name + "edge mappings", containerBytes (child.m_global_edge)
+                                              + containerBytes (child.m_local_edge));
+            addChildren (child, name, report);
+          }
+        }
+      };
+
+    }
+
+  }
+
+}
+
+template <typename Graph> pcl::graph::MemoryReport
+pcl::graph::computeMemoryUsage (const Graph& graph)
+{
+  BOOST_CONCEPT_ASSERT ((pcl::graph::PointCloudGraphConcept<Graph>));
+
+  MemoryReport report;
+  report.setNumberOfVertices (boost::num_vertices (graph));
+  report.setNumberOfEdges (boost::num_edges (graph));
+  detail::memory_usage<Graph> () (graph, report);
+  return (report);
+}
+
+#endif /* PCL_GRAPH_IMPL_MEMORY_USAGE_HPP */
@@ -0,0 +1,357 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_MESH_GRAPH_BUILDER_HPP
+#define PCL_GRAPH_IMPL_MESH_GRAPH_BUILDER_HPP
+
+#include <algorithm>
+
+#include <boost/utility/enable_if.hpp>
+
+#include <Eigen/Geometry>
+
+#include <pcl/conversions.h>
+#include <pcl/common/io.h>
+#include <pcl/console/print.h>
+
+#include "graph/utils.h"
+#include "graph/arena_allocator.h"
+#include "graph/mesh_graph_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    namespace detail
+    {
+
+      /* AssignNormal and AssignCurvature write a normal (curvature) into a
+       * point. The versions for the point types without the corresponding
+       * fields do nothing. */
+
+      template <typename PointT, typename Enable = void>
+      struct AssignNormal
+      {
+        static void
+        apply (PointT&, const Eigen::Vector3f&)
+        {
+        }
+      };
+
+      template <typename PointT>
+      struct AssignNormal<PointT, typename boost::enable_if<pcl::traits::has_normal<PointT> >::type>
+      {
+        static void
+        apply (PointT& p, const Eigen::Vector3f& normal)
+        {
+          p.getNormalVector3fMap () = normal;
+        }
+      };
+
+      template <typename PointT, typename Enable = void>
+      struct AssignCurvature
+      {
+        static void
+        apply (PointT&, float)
+        {
+        }
+      };
+
+      template <typename PointT>
+      struct AssignCurvature<PointT, typename boost::enable_if<pcl::traits::has_curvature<PointT> >::type>
+      {
+        static void
+        apply (PointT& p, float curvature)
+        {
+          p.curvature = curvature;
+        }
+      };
+
+    }
+
+  }
+
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::MeshGraphBuilder<PointT, GraphT>::setInputMesh (const pcl::PolygonMesh::ConstPtr& mesh)
+{
+  typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT>);
+  pcl::fromPCLPointCloud2 (mesh->cloud, *cloud);
+  this->setInputCloud (cloud);
+  // Share the ownership of the mesh instead of copying the polygons
+  polygons_ = PolygonsConstPtr (mesh, &mesh->polygons);
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::MeshGraphBuilder<PointT, GraphT>::compute (GraphT& graph)
+{
+  using namespace detail;
+
+  if (!initCompute ())
+  {
+    graph = GraphT ();
+    deinitCompute ();
+    return;
+  }
+
+  if (!polygons_)
+  {
+    PCL_ERROR ("[pcl::graph::MeshGraphBuilder::compute] No polygons were given.\n");
+    graph = GraphT ();
+    point_to_vertex_map_.clear ();
+    deinitCompute ();
+    return;
+  }
+
+  typedef std::pair<VertexId, VertexId> VertexPair;
+  const VertexId nil = std::numeric_limits<VertexId>::max ();
+  const std::vector<pcl::Vertices>& polygons = *polygons_;
+  const size_t num_points = input_->size ();
+  const size_t num_vertices = indices_->size ();
+  const int num_chunks = getMaxNumberOfThreads ();
+
+  point_to_vertex_map_.clear ();
+  point_to_vertex_map_.resize (num_points, nil);
+  for (size_t i = 0; i < num_vertices; ++i)
+    point_to_vertex_map_[indices_->operator[] (i)] = i;
+
+  // Step 1: collect polygon sides as (min, max) vertex pairs, then sort and
+  // remove duplicates (the sides shared by two polygons). The pairs are
+  // bucketed by the smaller vertex with a counting sort, so only the short
+  // per-vertex lists of larger vertices need to be sorted.
+  std::vector<VertexPair> edges;
+  {
+    std::vector<std::vector<VertexPair> > chunk_edges (num_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static, 1)
+#endif
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+    {
+      const std::pair<size_t, size_t> range = getChunkRange (chunk, num_chunks, polygons.size ());
+      std::vector<VertexPair>& pairs = chunk_edges[chunk];
+      pairs.reserve (3 * (range.second - range.first));
+      for (size_t i = range.first; i < range.second; ++i)
+      {
+        const std::vector<uint32_t>& vertices = polygons[i].vertices;
+        for (size_t k = 0; k < vertices.size (); ++k)
+        {
+          const uint32_t a = vertices[k];
+          const uint32_t b = vertices[(k + 1) % vertices.size ()];
+          if (a >= num_points || b >= num_points)
+            continue;
+          const VertexId va = point_to_vertex_map_[a];
+          const VertexId vb = point_to_vertex_map_[b];
+          if (va != nil && vb != nil && va != vb)
+            pairs.push_back (std::make_pair (std::min (va, vb), std::max (va, vb)));
+        }
+      }
+    }
+    std::vector<size_t> offsets (num_vertices + 1, 0);
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+      for (size_t i = 0; i < chunk_edges[chunk].size (); ++i)
+        ++offsets[chunk_edges[chunk][i].first + 1];
+    for (size_t v = 0; v < num_vertices; ++v)
+      offsets[v + 1] += offsets[v];
+    std::vector<VertexId> targets (offsets[num_vertices]);
+    {
+      std::vector<size_t> next (offsets.begin (), offsets.end () - 1);
+      for (int chunk = 0; chunk < num_chunks; ++chunk)
+      {
+        for (size_t i = 0; i < chunk_edges[chunk].size (); ++i)
+          targets[next[chunk_edges[chunk][i].first]++] = chunk_edges[chunk][i].second;
+        std::vector<VertexPair> ().swap (chunk_edges[chunk]);
+      }
+    }
+
+    std::vector<size_t> num_unique (num_vertices + 1, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int v = 0; v < static_cast<int> (num_vertices); ++v)
+    {
+      const typename std::vector<VertexId>::iterator begin = targets.begin () + offsets[v];
+      const typename std::vector<VertexId>::iterator end = targets.begin () + offsets[v + 1];
+      std::sort (begin, end);
+      num_unique[v + 1] = std::unique (begin, end) - begin;
+    }
+    for (size_t v = 0; v < num_vertices; ++v)
+      num_unique[v + 1] += num_unique[v];
+
+    edges.resize (num_unique[num_vertices]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int v = 0; v < static_cast<int> (num_vertices); ++v)
+      for (size_t i = num_unique[v]; i < num_unique[v + 1]; ++i)
+        edges[i] = std::make_pair (static_cast<VertexId> (v), targets[offsets[v] + i - num_unique[v]]);
+  }
+
+  // Step 2: compute vertex normals. The sum of the cross products over the
+  // triangle fan of a polygon is its normal scaled by twice its area. The
+  // polygons are grouped by vertex (counting sort), so that each vertex
+  // sums up the normals of its polygons independently.
+  std::vector<Eigen::Vector3f> normals;
+  if (pcl::traits::has_normal<PointOutT>::value)
+  {
+    std::vector<Eigen::Vector3f> polygon_normals (polygons.size ());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < static_cast<int> (polygons.size ()); ++i)
+    {
+      const std::vector<uint32_t>& vertices = polygons[i].vertices;
+      Eigen::Vector3f normal = Eigen::Vector3f::Zero ();
+      bool valid = vertices.size () >= 3;
+      for (size_t k = 0; k < vertices.size () && valid; ++k)
+        valid = vertices[k] < num_points;
+      if (valid)
+      {
+        const Eigen::Vector3f p0 = input_->operator[] (vertices[0]).getVector3fMap ();
+        for (size_t k = 1; k + 1 < vertices.size (); ++k)
+        {
+          const Eigen::Vector3f p1 = input_->operator[] (vertices[k]).getVector3fMap ();
+          const Eigen::Vector3f p2 = input_->operator[] (vertices[k + 1]).getVector3fMap ();
+          normal += (p1 - p0).cross (p2 - p0);
+        }
+      }
+      polygon_normals[i] = normal;
+    }
+
+    std::vector<size_t> offsets (num_vertices + 1, 0);
+    for (size_t i = 0; i < polygons.size (); ++i)
+      for (size_t k = 0; k < polygons[i].vertices.size (); ++k)
+        if (polygons[i].vertices[k] < num_points && point_to_vertex_map_[polygons[i].vertices[k]] != nil)
+          ++offsets[point_to_vertex_map_[polygons[i].vertices[k]] + 1];
+    for (size_t v = 0; v < num_vertices; ++v)
+      offsets[v + 1] += offsets[v];
+    std::vector<size_t> vertex_polygons (offsets[num_vertices]);
+    {
+      std::vector<size_t> next (offsets.begin (), offsets.end () - 1);
+      for (size_t i = 0; i < polygons.size (); ++i)
+        for (size_t k = 0; k < polygons[i].vertices.size (); ++k)
+          if (polygons[i].vertices[k] < num_points && point_to_vertex_map_[polygons[i].vertices[k]] != nil)
+            vertex_polygons[next[point_to_vertex_map_[polygons[i].vertices[k]]]++] = i;
+    }
+
+    normals.resize (num_vertices);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int v = 0; v < static_cast<int> (num_vertices); ++v)
+    {
+      Eigen::Vector3f normal = Eigen::Vector3f::Zero ();
+      for (size_t i = offsets[v]; i < offsets[v + 1]; ++i)
+        normal += polygon_normals[vertex_polygons[i]];
+      if (normal.squaredNorm () > 0.0f)
+        normal.normalize ();
+      normals[v] = normal;
+    }
+  }
+
+  // Step 3: compute vertex curvatures from the normals of the neighbors.
+  // The edges are grouped by vertex (both ends) with a counting sort.
+  std::vector<float> curvatures;
+  if (pcl::traits::has_normal<PointOutT>::value && pcl::traits::has_curvature<PointOutT>::value)
+  {
+    std::vector<size_t> offsets (num_vertices + 1, 0);
+    for (size_t i = 0; i < edges.size (); ++i)
+    {
+      ++offsets[edges[i].first + 1];
+      ++offsets[edges[i].second + 1];
+    }
+    for (size_t v = 0; v < num_vertices; ++v)
+      offsets[v + 1] += offsets[v];
+    std::vector<VertexId> neighbors (offsets[num_vertices]);
+    {
+      std::vector<size_t> next (offsets.begin (), offsets.end () - 1);
+      for (size_t i = 0; i < edges.size (); ++i)
+      {
+        neighbors[next[edges[i].first]++] = edges[i].second;
+        neighbors[next[edges[i].second]++] = edges[i].first;
+      }
+    }
+
+    curvatures.resize (num_vertices, 0.0f);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int v = 0; v < static_cast<int> (num_vertices); ++v)
+    {
+      if (offsets[v + 1] == offsets[v])
+        continue;
+      const Eigen::Vector3f p = input_->operator[] (indices_->operator[] (v)).getVector3fMap ();
+      float curvature = 0.0f;
+      for (size_t i = offsets[v]; i < offsets[v + 1]; ++i)
+      {
+        const VertexId n = neighbors[i];
+        curvature += normals[n].dot (p - input_->operator[] (indices_->operator[] (n)).getVector3fMap ());
+      }
+      curvatures[v] = curvature / ((offsets[v + 1] - offsets[v]) * 0.001f);
+    }
+  }
+
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (edges.size ()))));
+
+  typename pcl::PointCloud<PointOutT>::Ptr cloud (new pcl::PointCloud<PointOutT>);
+  pcl::copyPointCloud (*input_, *indices_, *cloud);
+  if (!normals.empty ())
+  {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int v = 0; v < static_cast<int> (num_vertices); ++v)
+    {
+      AssignNormal<PointOutT>::apply (cloud->operator[] (v), normals[v]);
+      if (!curvatures.empty ())
+        AssignCurvature<PointOutT>::apply (cloud->operator[] (v), curvatures[v]);
+    }
+  }
+
+  graph = GraphT (cloud);
+  bindEdgeListToCurrentArena (graph);
+  for (size_t i = 0; i < edges.size (); ++i)
+    boost::add_edge (edges[i].first, edges[i].second, graph);
+
+  this->applyVertexOrdering (graph);
+  deinitCompute ();
+}
+
+#endif /* PCL_GRAPH_IMPL_MESH_GRAPH_BUILDER_HPP */
+
@@ -38,12 +38,19 @@
 #ifndef PCL_GRAPH_IMPL_NEAREST_NEIGHBORS_GRAPH_BUILDER_HPP
 #define PCL_GRAPH_IMPL_NEAREST_NEIGHBORS_GRAPH_BUILDER_HPP
 
+#include <algorithm>
+
 #include <pcl/point_types.h>
 #include <pcl/common/io.h>
 #include <pcl/common/point_tests.h>
 #include <pcl/search/kdtree.h>
 #include <pcl/search/organized.h>
+#include <pcl/common/common.h>
 
+#include "graph/utils.h"
+#include "graph/voxel_hash.h"
+#include "graph/voxel_budget.h"
+#include "graph/arena_allocator.h"
 #include "graph/nearest_neighbors_graph_builder.h"
 
 template <typename PointT, typename GraphT> void
@@ -66,12 +73,29 @@ pcl::graph::NearestNeighborsGraphBuilder<PointT, GraphT>::compute (GraphT& graph
   }
   indices_->resize (k);
 
+  // If there are more points than the vertex budget allows, select one
+  // representative point per voxel of the finest grid that meets the budget.
+  std::vector<int> representatives;
+  std::vector<size_t> voxels;
+  const bool subsample = max_num_vertices_ > 0 && indices_->size () > max_num_vertices_;
+  if (subsample)
+  {
+    Eigen::Vector4f min, max;
+    pcl::getMinMax3D (*input_, *indices_, min, max);
+    const Eigen::Vector3d origin = min.head<3> ().template cast<double> ();
+    const float extent = (max - min).head<3> ().maxCoeff ();
+    const float min_resolution = extent > 0.0f ? extent / (MAX_VOXEL_KEY - 1) : 1.0f;
+    detail::GridVoxelCounter<PointT> counter (*input_, *indices_, origin);
+    const float resolution = computeBudgetedVoxelResolution (min_resolution, max_num_vertices_, counter);
+    selectVoxelRepresentatives (*input_, *indices_, origin, resolution, representatives, voxels);
+  }
+  const std::vector<int>& vertex_indices = subsample ? representatives : *indices_;
+
   // Create a new point cloud which will be the basis for the constructed graph.
   // All the fields that are also present in the output point type will be
   // copied over from the original point cloud.
   typename pcl::PointCloud<PointOutT>::Ptr cloud (new pcl::PointCloud<PointOutT>);
-  pcl::copyPointCloud (*input_, *indices_, *cloud);
-  graph = GraphT (cloud);
+  pcl::copyPointCloud (*input_, vertex_indices, *cloud);
 
   // In case a search method has not been given, initialize it using defaults
   if (!search_)
@@ -84,37 +108,82 @@ pcl::graph::NearestNeighborsGraphBuilder<PointT, GraphT>::compute (GraphT& graph
       search_.reset (new pcl::search::KdTree<PointOutT>);
   }
 
-  // Establish edges with nearest neighbors.
-  std::vector<int> neighbors (num_neighbors_ + 1);
-  std::vector<float> distances (num_neighbors_ + 1);
+  // Find nearest neighbors of all points. The points are split into chunks
+  // that are processed in parallel; each chunk produces a list of (min, max)
+  // vertex pairs.
+  typedef std::pair<VertexId, VertexId> VertexPair;
   search_->setInputCloud (cloud);
-  for (size_t i = 0; i < cloud->size (); ++i)
+  const int num_chunks = detail::getMaxNumberOfThreads ();
+  std::vector<std::vector<VertexPair> > chunk_edges (num_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static, 1)
+#endif
+  for (int chunk = 0; chunk < num_chunks; ++chunk)
+  {
+    const std::pair<size_t, size_t> range = detail::getChunkRange (chunk, num_chunks, cloud->size ());
+    std::vector<VertexPair>& edges = chunk_edges[chunk];
+    edges.reserve (num_neighbors_ * (range.second - range.first));
+    std::vector<int> neighbors (num_neighbors_ + 1);
+    std::vector<float> distances (num_neighbors_ + 1);
+    for (size_t i = range.first; i < range.second; ++i)
+    {
+      switch (search_type_)
+      {
+        case KNN:
+          {
+            // Search for num_neighbors_ + 1 because the first neighbor output by KdTree
+            // is always the query point itself.
+            search_->nearestKSearch (i, num_neighbors_ + 1, neighbors, distances);
+            break;
+          }
+        case RADIUS:
+          {
+            search_->radiusSearch (i, radius_, neighbors, distances, num_neighbors_ + 1);
+            break;
+          }
+      }
+      for (size_t j = 1; j < neighbors.size (); ++j)
+      {
+        const VertexId n = neighbors[j];
+        edges.push_back (std::make_pair (std::min<VertexId> (i, n), std::max<VertexId> (i, n)));
+      }
+    }
+  }
+
+  // Merge the chunks, sort, and remove duplicate pairs (neighborhood relation
+  // is not symmetric, so the same edge may be found from both of its ends).
+  std::vector<VertexPair> edges;
   {
-    switch (search_type_)
+    size_t num_pairs = 0;
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+      num_pairs += chunk_edges[chunk].size ();
+    edges.reserve (num_pairs);
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
     {
-      case KNN:
-        {
-          // Search for num_neighbors_ + 1 because the first neighbor output by KdTree
-          // is always the query point itself.
-          search_->nearestKSearch (i, num_neighbors_ + 1, neighbors, distances);
-          break;
-        }
-      case RADIUS:
-        {
-          search_->radiusSearch (i, radius_, neighbors, distances, num_neighbors_ + 1);
-          break;
-        }
+      edges.insert (edges.end (), chunk_edges[chunk].begin (), chunk_edges[chunk].end ());
+      std::vector<VertexPair> ().swap (chunk_edges[chunk]);
     }
-    for (size_t j = 1; j < neighbors.size (); ++j)
-      if (!boost::edge (i, neighbors[j], graph).second)
-        boost::add_edge (i, neighbors[j], graph);
   }
+  std::sort (edges.begin (), edges.end ());
+  edges.erase (std::unique (edges.begin (), edges.end ()), edges.end ());
+
+  // The number of edges is known exactly at this point. If the graph type
+  // supports it, adjacency storage will be allocated in a single arena sized
+  // accordingly.
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (edges.size ()))));
+
+  graph = GraphT (cloud);
+  bindEdgeListToCurrentArena (graph);
+  for (size_t i = 0; i < edges.size (); ++i)
+    boost::add_edge (edges[i].first, edges[i].second, graph);
 
   // Create point to vertex map
+  point_to_vertex_map_.clear ();
   point_to_vertex_map_.resize (input_->size (), std::numeric_limits<VertexId>::max ());
-  VertexId v = 0;
   for (size_t i = 0; i < indices_->size (); ++i)
-    point_to_vertex_map_[indices_->operator[] (i)] = v++;
+    point_to_vertex_map_[indices_->operator[] (i)] = subsample ? voxels[i] : i;
+
+  this->applyVertexOrdering (graph);
 }
 
 #endif /* PCL_GRAPH_IMPL_NEAREST_NEIGHBORS_GRAPH_BUILDER_HPP */
@@ -0,0 +1,165 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_ORGANIZED_GRAPH_BUILDER_HPP
+#define PCL_GRAPH_IMPL_ORGANIZED_GRAPH_BUILDER_HPP
+
+#include <cmath>
+
+#include <pcl/console/print.h>
+#include <pcl/common/centroid.h>
+#include <pcl/common/point_tests.h>
+
+#include "graph/arena_allocator.h"
+#include "graph/organized_graph_builder.h"
+
+template <typename PointT, typename GraphT> void
+pcl::graph::OrganizedGraphBuilder<PointT, GraphT>::compute (GraphT& graph)
+{
+  if (!initCompute ())
+  {
+    graph = GraphT ();
+    deinitCompute ();
+    return;
+  }
+
+  if (!input_->isOrganized ())
+  {
+    PCL_ERROR ("[pcl::graph::OrganizedGraphBuilder::compute] Input point cloud is not organized.\n");
+    graph = GraphT ();
+    point_to_vertex_map_.clear ();
+    deinitCompute ();
+    return;
+  }
+
+  const VertexId nil = std::numeric_limits<VertexId>::max ();
+  const size_t width = input_->width;
+  const size_t bins_x = (width + bin_size_ - 1) / bin_size_;
+  const size_t bins_y = (input_->height + bin_size_ - 1) / bin_size_;
+  const size_t num_bins = bins_x * bins_y;
+
+  // Step 1: assign every finite point to a bin and group the points by bin
+  // (counting sort). Without binning each bin is a single pixel.
+  std::vector<size_t> point_bin (indices_->size (), num_bins);
+  std::vector<size_t> bin_offset (num_bins + 1, 0);
+  for (size_t i = 0; i < indices_->size (); ++i)
+  {
+    const int index = indices_->operator[] (i);
+    if (!pcl::isFinite (input_->operator[] (index)))
+      continue;
+    const size_t row = index / width;
+    const size_t col = index % width;
+    point_bin[i] = (row / bin_size_) * bins_x + col / bin_size_;
+    ++bin_offset[point_bin[i] + 1];
+  }
+  for (size_t b = 0; b < num_bins; ++b)
+    bin_offset[b + 1] += bin_offset[b];
+  std::vector<int> bin_points (bin_offset[num_bins]);
+  {
+    std::vector<size_t> next (bin_offset.begin (), bin_offset.end () - 1);
+    for (size_t i = 0; i < indices_->size (); ++i)
+      if (point_bin[i] != num_bins)
+        bin_points[next[point_bin[i]]++] = indices_->operator[] (i);
+  }
+
+  // Step 2: every non-empty bin becomes a vertex, vertices are numbered in
+  // row-major bin order.
+  std::vector<VertexId> bin_to_vertex (num_bins, nil);
+  size_t num_vertices = 0;
+  for (size_t b = 0; b < num_bins; ++b)
+    if (bin_offset[b + 1] > bin_offset[b])
+      bin_to_vertex[b] = num_vertices++;
+
+  // Each vertex contributes at most 2 (4-connectivity) or 4 (8-connectivity)
+  // edges to its forward neighbors.
+  const size_t edges_per_vertex = connectivity_ == CONNECTIVITY_4 ? 2 : 4;
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (edges_per_vertex * num_vertices))));
+
+  graph = GraphT (num_vertices);
+  bindEdgeListToCurrentArena (graph);
+  point_to_vertex_map_.clear ();
+  point_to_vertex_map_.resize (input_->size (), nil);
+
+  // Step 3: compute bin centroids and fill in the point to vertex map.
+  for (size_t b = 0; b < num_bins; ++b)
+  {
+    const VertexId v = bin_to_vertex[b];
+    if (v == nil)
+      continue;
+    pcl::CentroidPoint<PointInT> centroid;
+    for (size_t j = bin_offset[b]; j < bin_offset[b + 1]; ++j)
+    {
+      centroid.add (input_->operator[] (bin_points[j]));
+      point_to_vertex_map_[bin_points[j]] = v;
+    }
+    centroid.get (graph[v]);
+  }
+
+  // Step 4: connect every bin with its right and bottom (and, in case of
+  // 8-connectivity, bottom-left and bottom-right) neighbors. This way each
+  // pair of adjacent bins is visited exactly once.
+  const int offsets[4][2] = { { 0, 1 }, { 1, 0 }, { 1, -1 }, { 1, 1 } };
+  for (size_t row = 0; row < bins_y; ++row)
+  {
+    for (size_t col = 0; col < bins_x; ++col)
+    {
+      const VertexId v1 = bin_to_vertex[row * bins_x + col];
+      if (v1 == nil)
+        continue;
+      const float z1 = graph[v1].z;
+      for (size_t k = 0; k < edges_per_vertex; ++k)
+      {
+        const size_t r = row + offsets[k][0];
+        const size_t c = col + offsets[k][1];
+        // Unsigned wrap-around takes care of the negative column offset.
+        if (r >= bins_y || c >= bins_x)
+          continue;
+        const VertexId v2 = bin_to_vertex[r * bins_x + c];
+        if (v2 == nil)
+          continue;
+        const float z2 = graph[v2].z;
+        if (std::fabs (z1 - z2) <= depth_threshold_ * std::min (z1, z2))
+          boost::add_edge (v1, v2, graph);
+      }
+    }
+  }
+
+  this->applyVertexOrdering (graph);
+}
+
+#endif /* PCL_GRAPH_IMPL_ORGANIZED_GRAPH_BUILDER_HPP */
+
@@ -0,0 +1,273 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_REORDER_HPP
+#define PCL_GRAPH_IMPL_REORDER_HPP
+
+#include <algorithm>
+
+#include <boost/concept_check.hpp>
+#include <boost/graph/cuthill_mckee_ordering.hpp>
+
+#include <pcl/point_cloud.h>
+
+#include "graph/reorder.h"
+#include "graph/utils.h"
+#include "graph/arena_allocator.h"
+#include "graph/point_cloud_graph.h"
+#include "graph/point_cloud_graph_concept.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    namespace detail
+    {
+
+      /** Spread the lower 21 bits of a number so that there are two zero bits
+        * between each pair of consecutive bits. */
+      inline uint64_t
+      spreadBits3 (uint64_t x)
+      {
+        x &= 0x1fffff;
+        x = (x | x << 32) & 0x001f00000000ffffull;
+        x = (x | x << 16) & 0x001f0000ff0000ffull;
+        x = (x | x <<  8) & 0x100f00f00f00f00full;
+        x = (x | x <<  4) & 0x10c30c30c30c30c3ull;
+        x = (x | x <<  2) & 0x1249249249249249ull;
+        return (x);
+      }
+
+      /** Inverse of spreadBits3(), gathers every third bit of a number
+        * starting from the lowest one. */
+      inline uint32_t
+      compactBits3 (uint64_t x)
+      {
+        x &= 0x1249249249249249ull;
+        x = (x ^ (x >>  2)) & 0x10c30c30c30c30c3ull;
+        x = (x ^ (x >>  4)) & 0x100f00f00f00f00full;
+        x = (x ^ (x >>  8)) & 0x001f0000ff0000ffull;
+        x = (x ^ (x >> 16)) & 0x001f00000000ffffull;
+        x = (x ^ (x >> 32)) & 0x00000000001fffffull;
+        return (static_cast<uint32_t> (x));
+      }
+
+      /** Compute 63-bit Morton code of a point given integer grid coordinates
+        * (21 bits per axis). */
+      inline uint64_t
+      mortonCode (uint32_t x, uint32_t y, uint32_t z)
+      {
+        return (spreadBits3 (x) | spreadBits3 (y) << 1 | spreadBits3 (z) << 2);
+      }
+
+    }
+
+  }
+
+}
+
+template <typename Graph> void
+pcl::graph::computeMortonOrder (const Graph& graph,
+                                std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& order)
+{
+  BOOST_CONCEPT_ASSERT ((pcl::graph::PointCloudGraphConcept<Graph>));
+
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+  typedef std::pair<uint64_t, VertexId> CodeVertexPair;
+
+  const size_t num_vertices = boost::num_vertices (graph);
+
+  Eigen::Vector3f min = Eigen::Vector3f::Constant (std::numeric_limits<float>::max ());
+  Eigen::Vector3f max = Eigen::Vector3f::Constant (-std::numeric_limits<float>::max ());
+  for (VertexId v = 0; v < num_vertices; ++v)
+  {
+    const Eigen::Vector3f& p = graph[v].getVector3fMap ();
+    if (pcl_isfinite (p[0]) && pcl_isfinite (p[1]) && pcl_isfinite (p[2]))
+    {
+      min = min.cwiseMin (p);
+      max = max.cwiseMax (p);
+    }
+  }
+
+  // Quantize coordinates to a 2^21 grid spanning the bounding box
+  const float extent = (max - min).maxCoeff ();
+  const float scale = extent > 0.0f ? ((1 << 21) - 1) / extent : 0.0f;
+
+  std::vector<CodeVertexPair> codes (num_vertices);
+  for (VertexId v = 0; v < num_vertices; ++v)
+  {
+    const Eigen::Vector3f& p = graph[v].getVector3fMap ();
+    codes[v].second = v;
+    if (pcl_isfinite (p[0]) && pcl_isfinite (p[1]) && pcl_isfinite (p[2]))
+    {
+      Eigen::Vector3f q = (p - min) * scale;
+      codes[v].first = detail::mortonCode (static_cast<uint32_t> (q[0]),
+                                           static_cast<uint32_t> (q[1]),
+                                           static_cast<uint32_t> (q[2]));
+    }
+    else
+    {
+      codes[v].first = std::numeric_limits<uint64_t>::max ();
+    }
+  }
+
+  std::sort (codes.begin (), codes.end ());
+
+  order.resize (num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i)
+    order[i] = codes[i].second;
+}
+
+template <typename Graph> void
+pcl::graph::computeReverseCuthillMcKeeOrder (const Graph& graph,
+                                             std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& order)
+{
+  order.resize (boost::num_vertices (graph));
+  boost::cuthill_mckee_ordering (graph,
+                                 order.rbegin (),
+                                 boost::get (boost::vertex_index, graph));
+}
+
+template <typename Graph> void
+pcl::graph::detail::relabelVertices (Graph& graph,
+                                     const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& new_id,
+                                     size_t num_new_vertices)
+{
+  BOOST_CONCEPT_ASSERT ((pcl::graph::PointCloudGraphConcept<Graph>));
+
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+  typedef typename point_cloud_graph_traits<Graph>::point_cloud_type PointCloud;
+  typedef typename underlying_graph<Graph>::type UnderlyingGraph;
+  typedef typename boost::graph_traits<UnderlyingGraph>::edge_iterator EdgeIterator;
+  typedef typename UnderlyingGraph::vertex_property_type VertexProperty;
+  typedef typename UnderlyingGraph::edge_property_type EdgeProperty;
+
+  struct Edge
+  {
+    VertexId source;
+    VertexId target;
+    EdgeProperty property;
+    bool operator< (const Edge& other) const
+    {
+      return (source < other.source || (source == other.source && target < other.target));
+    }
+  };
+
+  const size_t num_vertices = boost::num_vertices (graph);
+  assert (new_id.size () == num_vertices);
+
+  // Step 1: move points and vertex properties to their new positions.
+  UnderlyingGraph& data = underlying_graph<Graph> () (graph);
+  typename PointCloud::ConstPtr old_cloud = pcl::graph::point_cloud (graph);
+  typename PointCloud::Ptr cloud (new PointCloud);
+  cloud->header = old_cloud->header;
+  cloud->points.resize (num_new_vertices);
+  cloud->width = num_new_vertices;
+  cloud->height = 1;
+  std::vector<VertexProperty> vertex_properties (num_new_vertices);
+  for (size_t i = 0; i < num_vertices; ++i)
+  {
+    if (new_id[i] >= num_new_vertices)
+      continue;
+    cloud->points[new_id[i]] = old_cloud->points[i];
+    vertex_properties[new_id[i]] = data.m_vertices[i].m_property;
+  }
+
+  // Step 2: collect edges with remapped end points and sort them, dropping
+  // those that are incident to removed vertices.
+  std::vector<Edge> edges;
+  edges.reserve (boost::num_edges (graph));
+  EdgeIterator ei, ee;
+  for (boost::tie (ei, ee) = boost::edges (data); ei != ee; ++ei)
+  {
+    VertexId s = new_id[boost::source (*ei, data)];
+    VertexId t = new_id[boost::target (*ei, data)];
+    if (s >= num_new_vertices || t >= num_new_vertices)
+      continue;
+    Edge edge = { std::min (s, t), std::max (s, t), *static_cast<EdgeProperty*> (ei->get_property ()) };
+    edges.push_back (edge);
+  }
+  std::sort (edges.begin (), edges.end ());
+
+  // Step 3: rebuild the graph.
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (edges.size ()))));
+  graph = Graph (cloud);
+  bindEdgeListToCurrentArena (graph);
+  UnderlyingGraph& rebuilt = underlying_graph<Graph> () (graph);
+  for (size_t i = 0; i < num_new_vertices; ++i)
+    rebuilt.m_vertices[i].m_property = vertex_properties[i];
+  for (size_t i = 0; i < edges.size (); ++i)
+    boost::add_edge (edges[i].source, edges[i].target, edges[i].property, graph);
+}
+
+template <typename Graph> void
+pcl::graph::reorderVertices (Graph& graph,
+                             const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& order)
+{
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+
+  const size_t num_vertices = boost::num_vertices (graph);
+  assert (order.size () == num_vertices);
+
+  std::vector<VertexId> new_id (num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i)
+    new_id[order[i]] = i;
+
+  detail::relabelVertices (graph, new_id, num_vertices);
+}
+
+template <typename Graph> void
+pcl::graph::reorderVertices (Graph& graph,
+                             const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& order,
+                             std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& point_to_vertex_map)
+{
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+
+  reorderVertices (graph, order);
+
+  std::vector<VertexId> new_id (order.size ());
+  for (size_t i = 0; i < order.size (); ++i)
+    new_id[order[i]] = i;
+
+  for (size_t i = 0; i < point_to_vertex_map.size (); ++i)
+    if (point_to_vertex_map[i] < new_id.size ())
+      point_to_vertex_map[i] = new_id[point_to_vertex_map[i]];
+}
+
+#endif /* PCL_GRAPH_IMPL_REORDER_HPP */
@@ -0,0 +1,480 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_SUPERVOXEL_GRAPH_BUILDER_HPP
+#define PCL_GRAPH_IMPL_SUPERVOXEL_GRAPH_BUILDER_HPP
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <boost/utility/enable_if.hpp>
+
+#include <pcl/console/print.h>
+#include <pcl/common/common.h>
+#include <pcl/common/centroid.h>
+
+#include "graph/utils.h"
+#include "graph/voxel_hash.h"
+#include "graph/arena_allocator.h"
+#include "graph/voxel_grid_graph_builder.h"
+#include "graph/supervoxel_graph_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    namespace detail
+    {
+
+      /* PointColor and PointNormal extract the color (0..255 per channel) and
+       * the normal of a point as vectors. The versions for the point types
+       * without the corresponding fields return zero vectors. Non-finite
+       * normals are also returned as zero vectors. */
+
+      template <typename PointT, typename Enable = void>
+      struct PointColor
+      {
+        static Eigen::Vector3f
+        get (const PointT&)
+        {
+          return (Eigen::Vector3f::Zero ());
+        }
+      };
+
+      template <typename PointT>
+      struct PointColor<PointT, typename boost::enable_if<pcl::traits::has_color<PointT> >::type>
+      {
+        static Eigen::Vector3f
+        get (const PointT& p)
+        {
+          return (Eigen::Vector3f (p.r, p.g, p.b));
+        }
+      };
+
+      template <typename PointT, typename Enable = void>
+      struct PointNormal
+      {
+        static Eigen::Vector3f
+        get (const PointT&)
+        {
+          return (Eigen::Vector3f::Zero ());
+        }
+      };
+
+      template <typename PointT>
+      struct PointNormal<PointT, typename boost::enable_if<pcl::traits::has_normal<PointT> >::type>
+      {
+        static Eigen::Vector3f
+        get (const PointT& p)
+        {
+          const Eigen::Vector3f n = p.getNormalVector3fMap ();
+          return (n.allFinite () ? n : Eigen::Vector3f::Zero ());
+        }
+      };
+
+    }
+
+  }
+
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::SupervoxelGraphBuilder<PointT, GraphT>::compute (GraphT& graph)
+{
+  using namespace detail;
+
+  if (!initCompute ())
+  {
+    graph = GraphT ();
+    deinitCompute ();
+    return;
+  }
+
+  const VertexId nil = std::numeric_limits<VertexId>::max ();
+  const size_t no_label = std::numeric_limits<size_t>::max ();
+
+  if (!(voxel_resolution_ > 0.0f) || !(seed_resolution_ > 0.0f))
+  {
+    PCL_ERROR ("[pcl::graph::SupervoxelGraphBuilder::compute] Voxel and seed resolutions should be positive.\n");
+    graph = GraphT ();
+    point_to_vertex_map_.assign (input_->size (), nil);
+    deinitCompute ();
+    return;
+  }
+
+  pcl::PointCloud<pcl::PointXYZ> xyz;
+  transformPoints (*input_, false, xyz);
+  Eigen::Vector4f min, max;
+  pcl::getMinMax3D (xyz, *indices_, min, max);
+
+  std::vector<KeyIndexPair> pairs;
+  unsigned int depth;
+  if (!computeSortedVoxelCodes (xyz, *indices_, min, max, voxel_resolution_, pairs, depth))
+  {
+    PCL_ERROR ("[pcl::graph::SupervoxelGraphBuilder::compute] Voxel grid is too fine for the extent of the input cloud.\n");
+    graph = GraphT ();
+    point_to_vertex_map_.assign (input_->size (), nil);
+    deinitCompute ();
+    return;
+  }
+
+  // Step 1: find voxels (runs of equal codes) and compute their features.
+  std::vector<size_t> voxel_begin;
+  std::vector<uint64_t> voxel_keys;
+  for (size_t i = 0; i < pairs.size (); ++i)
+  {
+    if (i == 0 || pairs[i].code != pairs[i - 1].code)
+    {
+      const uint64_t code = pairs[i].code;
+      voxel_begin.push_back (i);
+      voxel_keys.push_back (packVoxelKey (compactBits3 (code >> 2), compactBits3 (code >> 1), compactBits3 (code)));
+    }
+  }
+  voxel_begin.push_back (pairs.size ());
+  const size_t num_voxels = voxel_keys.size ();
+
+  std::vector<Features> voxels (num_voxels);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int v = 0; v < static_cast<int> (num_voxels); ++v)
+  {
+    Features& f = voxels[v];
+    f.xyz.setZero ();
+    f.rgb.setZero ();
+    f.normal.setZero ();
+    for (size_t i = voxel_begin[v]; i < voxel_begin[v + 1]; ++i)
+    {
+      const PointInT& p = input_->operator[] (pairs[i].index);
+      f.xyz += p.getVector3fMap ();
+      f.rgb += PointColor<PointInT>::get (p);
+      f.normal += PointNormal<PointInT>::get (p);
+    }
+    const float n = static_cast<float> (voxel_begin[v + 1] - voxel_begin[v]);
+    f.xyz /= n;
+    f.rgb /= n;
+    if (f.normal.squaredNorm () > 0.0f)
+      f.normal.normalize ();
+  }
+
+  // Step 2: find the neighbors of the voxels (26-neighborhood) and store
+  // them in CSR format. First count the neighbors to get the offsets, then
+  // fill in the neighbor array.
+  VoxelHashTable table (num_voxels);
+  for (size_t v = 0; v < num_voxels; ++v)
+    table.insert (voxel_keys[v], v);
+  std::vector<size_t> offsets (num_voxels + 1, 0);
+  std::vector<size_t> neighbors;
+  for (int pass = 0; pass < 2; ++pass)
+  {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int v = 0; v < static_cast<int> (num_voxels); ++v)
+    {
+      uint32_t x, y, z;
+      unpackVoxelKey (voxel_keys[v], x, y, z);
+      size_t count = 0;
+      for (int dx = -1; dx <= 1; ++dx)
+        for (int dy = -1; dy <= 1; ++dy)
+          for (int dz = -1; dz <= 1; ++dz)
+          {
+            const uint32_t nx = x + dx;
+            const uint32_t ny = y + dy;
+            const uint32_t nz = z + dz;
+            // Negative coordinates wrap around and are caught here as well
+            if ((dx == 0 && dy == 0 && dz == 0) || nx >= MAX_VOXEL_KEY || ny >= MAX_VOXEL_KEY || nz >= MAX_VOXEL_KEY)
+              continue;
+            size_t neighbor;
+            if (!table.find (packVoxelKey (nx, ny, nz), neighbor))
+              continue;
+            if (pass == 1)
+              neighbors[offsets[v] + count] = neighbor;
+            ++count;
+          }
+      if (pass == 0)
+        offsets[v + 1] = count;
+    }
+    if (pass == 0)
+    {
+      for (size_t v = 0; v < num_voxels; ++v)
+        offsets[v + 1] += offsets[v];
+      neighbors.resize (offsets[num_voxels]);
+    }
+  }
+
+  // Step 3: place seeds. In each cell of the seed grid the voxel closest to
+  // the average position of the voxels in the cell becomes a seed.
+  std::vector<size_t> seeds;
+  {
+    VoxelHashTable seed_table (num_voxels);
+    std::vector<size_t> voxel_cell (num_voxels);
+    std::vector<Eigen::Vector3f> cell_xyz;
+    std::vector<size_t> cell_size;
+    const Eigen::Vector3f origin = min.head<3> ();
+    for (size_t v = 0; v < num_voxels; ++v)
+    {
+      const Eigen::Vector3f c = (voxels[v].xyz - origin) / seed_resolution_;
+      const uint64_t key = packVoxelKey (c[0], c[1], c[2]);
+      size_t cell;
+      if (!seed_table.find (key, cell))
+      {
+        cell = cell_xyz.size ();
+        seed_table.insert (key, cell);
+        cell_xyz.push_back (Eigen::Vector3f::Zero ());
+        cell_size.push_back (0);
+      }
+      voxel_cell[v] = cell;
+      cell_xyz[cell] += voxels[v].xyz;
+      ++cell_size[cell];
+    }
+    std::vector<float> best_distance (cell_xyz.size (), std::numeric_limits<float>::max ());
+    seeds.resize (cell_xyz.size ());
+    for (size_t v = 0; v < num_voxels; ++v)
+    {
+      const size_t cell = voxel_cell[v];
+      const float d = (voxels[v].xyz - cell_xyz[cell] / cell_size[cell]).squaredNorm ();
+      if (d < best_distance[cell])
+      {
+        best_distance[cell] = d;
+        seeds[cell] = v;
+      }
+    }
+  }
+
+  // Step 4: grow supervoxels from the seeds, update their centers, and move
+  // the seeds to the voxels closest to the centers.
+  std::vector<Features> supervoxels (seeds.size ());
+  for (size_t s = 0; s < seeds.size (); ++s)
+    supervoxels[s] = voxels[seeds[s]];
+  std::vector<size_t> labels;
+  std::vector<size_t> member_offsets;
+  std::vector<size_t> members;
+  const size_t num_iterations = std::max<size_t> (num_iterations_, 1);
+  for (size_t iteration = 0; iteration < num_iterations; ++iteration)
+  {
+    labels.assign (num_voxels, no_label);
+    for (size_t s = 0; s < seeds.size (); ++s)
+      labels[seeds[s]] = s;
+    growSupervoxels (seeds, offsets, neighbors, voxels, supervoxels, labels);
+
+    // Voxels in the components without seeds start new supervoxels. They
+    // keep their seeds in the next iterations.
+    for (size_t v = 0; v < num_voxels; ++v)
+    {
+      if (labels[v] == no_label)
+      {
+        labels[v] = seeds.size ();
+        seeds.push_back (v);
+        supervoxels.push_back (voxels[v]);
+        growSupervoxels (std::vector<size_t> (1, v), offsets, neighbors, voxels, supervoxels, labels);
+      }
+    }
+
+    // Group voxels by supervoxels (counting sort)
+    const size_t num_supervoxels = seeds.size ();
+    member_offsets.assign (num_supervoxels + 1, 0);
+    for (size_t v = 0; v < num_voxels; ++v)
+      ++member_offsets[labels[v] + 1];
+    for (size_t s = 0; s < num_supervoxels; ++s)
+      member_offsets[s + 1] += member_offsets[s];
+    members.resize (num_voxels);
+    {
+      std::vector<size_t> next (member_offsets.begin (), member_offsets.end () - 1);
+      for (size_t v = 0; v < num_voxels; ++v)
+        members[next[labels[v]]++] = v;
+    }
+
+    if (iteration + 1 == num_iterations)
+      break;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int s = 0; s < static_cast<int> (num_supervoxels); ++s)
+    {
+      Features& f = supervoxels[s];
+      f.xyz.setZero ();
+      f.rgb.setZero ();
+      f.normal.setZero ();
+      for (size_t i = member_offsets[s]; i < member_offsets[s + 1]; ++i)
+      {
+        f.xyz += voxels[members[i]].xyz;
+        f.rgb += voxels[members[i]].rgb;
+        f.normal += voxels[members[i]].normal;
+      }
+      const float n = static_cast<float> (member_offsets[s + 1] - member_offsets[s]);
+      f.xyz /= n;
+      f.rgb /= n;
+      if (f.normal.squaredNorm () > 0.0f)
+        f.normal.normalize ();
+      float best_distance = std::numeric_limits<float>::max ();
+      for (size_t i = member_offsets[s]; i < member_offsets[s + 1]; ++i)
+      {
+        const float d = (voxels[members[i]].xyz - f.xyz).squaredNorm ();
+        if (d < best_distance)
+        {
+          best_distance = d;
+          seeds[s] = members[i];
+        }
+      }
+    }
+  }
+  const size_t num_supervoxels = seeds.size ();
+
+  // Step 5: connect supervoxels that have adjacent voxels.
+  typedef std::pair<VertexId, VertexId> VertexPair;
+  std::vector<VertexPair> edges;
+  {
+    const int num_chunks = getMaxNumberOfThreads ();
+    std::vector<std::vector<VertexPair> > chunk_edges (num_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static, 1)
+#endif
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+    {
+      const std::pair<size_t, size_t> range = getChunkRange (chunk, num_chunks, num_voxels);
+      for (size_t v = range.first; v < range.second; ++v)
+        for (size_t i = offsets[v]; i < offsets[v + 1]; ++i)
+          if (neighbors[i] > v && labels[neighbors[i]] != labels[v])
+            chunk_edges[chunk].push_back (std::make_pair (std::min (labels[v], labels[neighbors[i]]),
+                                                          std::max (labels[v], labels[neighbors[i]])));
+      std::sort (chunk_edges[chunk].begin (), chunk_edges[chunk].end ());
+      chunk_edges[chunk].erase (std::unique (chunk_edges[chunk].begin (), chunk_edges[chunk].end ()), chunk_edges[chunk].end ());
+    }
+    for (int chunk = 0; chunk < num_chunks; ++chunk)
+      edges.insert (edges.end (), chunk_edges[chunk].begin (), chunk_edges[chunk].end ());
+    std::sort (edges.begin (), edges.end ());
+    edges.erase (std::unique (edges.begin (), edges.end ()), edges.end ());
+  }
+
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (edges.size ()))));
+
+  graph = GraphT (num_supervoxels);
+  bindEdgeListToCurrentArena (graph);
+
+  point_to_vertex_map_.clear ();
+  point_to_vertex_map_.resize (input_->size (), nil);
+
+  // Step 6: compute supervoxel centroids and fill in the point to vertex
+  // map.
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int> (num_supervoxels); ++i)
+  {
+    const VertexId s = i;
+    pcl::CentroidPoint<PointInT> centroid;
+    for (size_t m = member_offsets[s]; m < member_offsets[s + 1]; ++m)
+    {
+      const size_t v = members[m];
+      for (size_t j = voxel_begin[v]; j < voxel_begin[v + 1]; ++j)
+      {
+        centroid.add (input_->operator[] (pairs[j].index));
+        point_to_vertex_map_[pairs[j].index] = s;
+      }
+    }
+    centroid.get (graph[s]);
+  }
+
+  for (size_t i = 0; i < edges.size (); ++i)
+    boost::add_edge (edges[i].first, edges[i].second, graph);
+
+  this->applyVertexOrdering (graph);
+  deinitCompute ();
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::SupervoxelGraphBuilder<PointT, GraphT>::growSupervoxels (std::vector<size_t> frontier,
+                                                                     const std::vector<size_t>& offsets,
+                                                                     const std::vector<size_t>& neighbors,
+                                                                     const std::vector<Features>& voxels,
+                                                                     const std::vector<Features>& supervoxels,
+                                                                     std::vector<size_t>& labels) const
+{
+  const size_t no_label = std::numeric_limits<size_t>::max ();
+  std::vector<size_t> candidates;
+  std::vector<size_t> candidate_labels;
+  while (!frontier.empty ())
+  {
+    // Unlabeled voxels adjacent to the frontier
+    candidates.clear ();
+    for (size_t i = 0; i < frontier.size (); ++i)
+      for (size_t j = offsets[frontier[i]]; j < offsets[frontier[i] + 1]; ++j)
+        if (labels[neighbors[j]] == no_label)
+          candidates.push_back (neighbors[j]);
+    std::sort (candidates.begin (), candidates.end ());
+    candidates.erase (std::unique (candidates.begin (), candidates.end ()), candidates.end ());
+
+    // Each of them joins the closest of the adjacent supervoxels. Labels
+    // are only read in this loop, so the result does not depend on the
+    // order in which candidates are processed.
+    candidate_labels.resize (candidates.size ());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < static_cast<int> (candidates.size ()); ++i)
+    {
+      const size_t v = candidates[i];
+      size_t best_label = no_label;
+      float best_distance = std::numeric_limits<float>::max ();
+      for (size_t j = offsets[v]; j < offsets[v + 1]; ++j)
+      {
+        const size_t label = labels[neighbors[j]];
+        if (label == no_label)
+          continue;
+        const float d = distance (voxels[v], supervoxels[label]);
+        if (d < best_distance || (d == best_distance && label < best_label))
+        {
+          best_distance = d;
+          best_label = label;
+        }
+      }
+      candidate_labels[i] = best_label;
+    }
+    for (size_t i = 0; i < candidates.size (); ++i)
+      labels[candidates[i]] = candidate_labels[i];
+
+    frontier.swap (candidates);
+  }
+}
+
+#endif /* PCL_GRAPH_IMPL_SUPERVOXEL_GRAPH_BUILDER_HPP */
+
@@ -0,0 +1,325 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_TILED_VOXEL_GRID_GRAPH_BUILDER_HPP
+#define PCL_GRAPH_IMPL_TILED_VOXEL_GRID_GRAPH_BUILDER_HPP
+
+#include <algorithm>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/console/print.h>
+#include <pcl/common/io.h>
+#include <pcl/common/centroid.h>
+
+#include "graph/voxel_hash.h"
+#include "graph/voxel_grid_graph_builder.h"
+#include "graph/tiled_voxel_grid_graph_builder.h"
+
+template <typename PointT, typename GraphT> bool
+pcl::graph::TiledVoxelGridGraphBuilder<PointT, GraphT>::compute (const PointSource& source,
+                                                                 const std::string& filename)
+{
+  namespace fs = boost::filesystem;
+
+  num_vertices_ = 0;
+  num_edges_ = 0;
+  num_tiles_ = 0;
+
+  boost::system::error_code error;
+  const fs::path base = temporary_directory_.empty () ? fs::temp_directory_path (error) : fs::path (temporary_directory_);
+  const fs::path directory = base / fs::unique_path ("tiled-graph-%%%%-%%%%-%%%%");
+  if (error || !fs::create_directories (directory, error))
+  {
+    PCL_ERROR ("[pcl::graph::TiledVoxelGridGraphBuilder::compute] Failed to create temporary directory.\n");
+    return (false);
+  }
+
+  // Step 1: pull the points from the source, compute their voxel keys, and
+  // spill them into per-tile files.
+  std::map<uint64_t, TileBuffer> tiles;
+  bool ok = true;
+  {
+    size_t num_buffered = 0;
+    pcl::PointCloud<PointT> chunk;
+    pcl::PointCloud<pcl::PointXYZ> transformed;
+    while (ok && source (chunk))
+    {
+      detail::transformPoints (chunk, use_transform_, transformed);
+      for (size_t i = 0; i < chunk.size (); ++i)
+      {
+        KeyedPoint kp;
+        const pcl::PointXYZ& p = transformed[i];
+        if (!computeAnchoredVoxelKey (p.x, p.y, p.z, voxel_resolution_, kp.key))
+          continue;
+        kp.point = chunk[i];
+        tiles[getTileKey (kp.key)].push_back (kp);
+        ++num_buffered;
+      }
+      if (num_buffered >= max_buffered_points_)
+      {
+        ok = flushTiles (directory.string (), tiles);
+        num_buffered = 0;
+      }
+    }
+    ok = ok && flushTiles (directory.string (), tiles);
+  }
+  num_tiles_ = tiles.size ();
+
+  // Step 2: build the vertices and the internal edges of every tile, and
+  // stitch the edges to the adjacent tiles that were processed before.
+  // The tiles are processed in the order of their keys, i.e. row by row and
+  // layer by layer. The boundary of a tile is kept only until its last
+  // neighbor, the one at offset (1, 1, 1), has been processed.
+  const fs::path vertices_path = directory / "vertices";
+  const fs::path edges_path = directory / "edges";
+  {
+    std::ofstream vertices (vertices_path.string ().c_str (), std::ios::binary);
+    std::ofstream edges (edges_path.string ().c_str (), std::ios::binary);
+    ok = ok && vertices && edges;
+    const uint64_t last_neighbor_offset = packVoxelKey (1, 1, 1);
+    std::map<uint64_t, Boundary> pending;
+    for (typename std::map<uint64_t, TileBuffer>::const_iterator it = tiles.begin (); ok && it != tiles.end (); ++it)
+    {
+      const fs::path tile_path = directory / ("tile-" + boost::lexical_cast<std::string> (it->first));
+      Boundary boundary;
+      ok = processTile (it->first, tile_path.string (), vertices, edges, boundary);
+      fs::remove (tile_path, error);
+      // Step 3: stitch the edges between the boundary voxels of this tile
+      // and of the adjacent tiles processed so far.
+      ok = ok && stitchTile (it->first, boundary, pending, edges);
+      while (!pending.empty () && pending.begin ()->first + last_neighbor_offset <= it->first)
+        pending.erase (pending.begin ());
+      if (!boundary.empty ())
+        pending[it->first].swap (boundary);
+    }
+    ok = ok && vertices && edges;
+  }
+
+  // Step 4: assemble the output file (see saveGraph()).
+  if (ok)
+  {
+    std::ofstream file (filename.c_str (), std::ios::binary);
+    std::ifstream vertices (vertices_path.string ().c_str (), std::ios::binary);
+    std::ifstream edges (edges_path.string ().c_str (), std::ios::binary);
+    file << pcl::PCDWriter::generateHeader<PointOutT> (pcl::PointCloud<PointOutT> (), static_cast<int> (num_vertices_));
+    file << "DATA binary\n";
+    if (num_vertices_)
+      file << vertices.rdbuf ();
+    file << "\n# Edges\n";
+    uint64_t edge[2];
+    while (edges.read (reinterpret_cast<char*> (edge), sizeof (edge)))
+      file << edge[0] << " " << edge[1] << " " << 0 << "\n";
+    ok = file.good ();
+  }
+
+  if (!ok)
+    PCL_ERROR ("[pcl::graph::TiledVoxelGridGraphBuilder::compute] Failed to write graph.\n");
+  fs::remove_all (directory, error);
+  return (ok);
+}
+
+template <typename PointT, typename GraphT> bool
+pcl::graph::TiledVoxelGridGraphBuilder<PointT, GraphT>::flushTiles (const std::string& directory,
+                                                                    std::map<uint64_t, TileBuffer>& buffers) const
+{
+  for (typename std::map<uint64_t, TileBuffer>::iterator it = buffers.begin (); it != buffers.end (); ++it)
+  {
+    if (it->second.empty ())
+      continue;
+    const boost::filesystem::path path = boost::filesystem::path (directory) / ("tile-" + boost::lexical_cast<std::string> (it->first));
+    std::ofstream file (path.string ().c_str (), std::ios::binary | std::ios::app);
+    file.write (reinterpret_cast<const char*> (&it->second[0]), it->second.size () * sizeof (KeyedPoint));
+    if (!file)
+      return (false);
+    TileBuffer ().swap (it->second);
+  }
+  return (true);
+}
+
+template <typename PointT, typename GraphT> bool
+pcl::graph::TiledVoxelGridGraphBuilder<PointT, GraphT>::processTile (uint64_t tile,
+                                                                     const std::string& path,
+                                                                     std::ofstream& vertices,
+                                                                     std::ofstream& edges,
+                                                                     Boundary& boundary)
+{
+  std::ifstream file (path.c_str (), std::ios::binary | std::ios::ate);
+  if (!file)
+    return (false);
+  TileBuffer points (static_cast<size_t> (file.tellg ()) / sizeof (KeyedPoint));
+  file.seekg (0);
+  if (points.empty () || !file.read (reinterpret_cast<char*> (&points[0]), points.size () * sizeof (KeyedPoint)))
+    return (false);
+
+  // Group the points by voxels (stable, so that the order in which points
+  // are accumulated does not depend on the sort implementation).
+  std::vector<std::pair<uint64_t, size_t> > order (points.size ());
+  for (size_t i = 0; i < points.size (); ++i)
+    order[i] = std::make_pair (points[i].key, i);
+  std::sort (order.begin (), order.end ());
+
+  // Fields of the output points, written packed (see pcl::PCDWriter).
+  std::vector<pcl::PCLPointField> fields;
+  pcl::getFields<PointOutT> (fields);
+
+  std::vector<uint64_t> voxel_keys;
+  for (size_t begin = 0; begin < order.size (); )
+  {
+    size_t end = begin;
+    pcl::CentroidPoint<PointT> centroid;
+    while (end < order.size () && order[end].first == order[begin].first)
+      centroid.add (points[order[end++].second].point);
+    PointOutT p;
+    centroid.get (p);
+    for (size_t i = 0; i < fields.size (); ++i)
+      if (fields[i].name != "_")
+        vertices.write (reinterpret_cast<const char*> (&p) + fields[i].offset, fields[i].count * pcl::getFieldSize (fields[i].datatype));
+    voxel_keys.push_back (order[begin].first);
+    begin = end;
+  }
+  TileBuffer ().swap (points);
+
+  // Connect adjacent voxels within the tile, remember the voxels on the
+  // tile boundary (they may have neighbors in other tiles).
+  VoxelHashTable table (voxel_keys.size ());
+  for (size_t i = 0; i < voxel_keys.size (); ++i)
+    table.insert (voxel_keys[i], i);
+  for (size_t i = 0; i < voxel_keys.size (); ++i)
+  {
+    uint32_t x, y, z;
+    unpackVoxelKey (voxel_keys[i], x, y, z);
+    if (x % tile_size_ == 0 || y % tile_size_ == 0 || z % tile_size_ == 0 ||
+        x % tile_size_ == tile_size_ - 1 || y % tile_size_ == tile_size_ - 1 || z % tile_size_ == tile_size_ - 1)
+      boundary.push_back (std::make_pair (voxel_keys[i], num_vertices_ + i));
+    for (size_t j = 0; j < 13; ++j)
+    {
+      const uint32_t nx = x + HALF_STENCIL[j][0];
+      const uint32_t ny = y + HALF_STENCIL[j][1];
+      const uint32_t nz = z + HALF_STENCIL[j][2];
+      if (nx >= MAX_VOXEL_KEY || ny >= MAX_VOXEL_KEY || nz >= MAX_VOXEL_KEY)
+        continue;
+      const uint64_t key = packVoxelKey (nx, ny, nz);
+      size_t neighbor;
+      if (getTileKey (key) == tile && table.find (key, neighbor))
+      {
+        const uint64_t edge[2] = { num_vertices_ + i, num_vertices_ + neighbor };
+        edges.write (reinterpret_cast<const char*> (edge), sizeof (edge));
+        ++num_edges_;
+      }
+    }
+  }
+
+  num_vertices_ += voxel_keys.size ();
+  return (vertices && edges);
+}
+
+template <typename PointT, typename GraphT> bool
+pcl::graph::TiledVoxelGridGraphBuilder<PointT, GraphT>::stitchTile (uint64_t tile,
+                                                                    const Boundary& boundary,
+                                                                    const std::map<uint64_t, Boundary>& pending,
+                                                                    std::ofstream& edges)
+{
+  // Collect the boundary voxels of the adjacent tiles that were processed
+  // before (only those are pending).
+  uint32_t tx, ty, tz;
+  unpackVoxelKey (tile, tx, ty, tz);
+  std::vector<const Boundary*> neighbors;
+  size_t num_voxels = 0;
+  for (size_t j = 0; j < 26; ++j)
+  {
+    const int sign = j < 13 ? 1 : -1;
+    const uint32_t nx = tx + sign * HALF_STENCIL[j % 13][0];
+    const uint32_t ny = ty + sign * HALF_STENCIL[j % 13][1];
+    const uint32_t nz = tz + sign * HALF_STENCIL[j % 13][2];
+    if (nx >= MAX_VOXEL_KEY || ny >= MAX_VOXEL_KEY || nz >= MAX_VOXEL_KEY)
+      continue;
+    typename std::map<uint64_t, Boundary>::const_iterator f = pending.find (packVoxelKey (nx, ny, nz));
+    if (f != pending.end ())
+    {
+      neighbors.push_back (&f->second);
+      num_voxels += f->second.size ();
+    }
+  }
+  if (neighbors.empty ())
+    return (true);
+
+  VoxelHashTable table (num_voxels);
+  for (size_t n = 0; n < neighbors.size (); ++n)
+    for (size_t i = 0; i < neighbors[n]->size (); ++i)
+      table.insert ((*neighbors[n])[i].first, (*neighbors[n])[i].second);
+
+  // Probe the full neighborhood of the voxels of this tile, every edge to
+  // a processed tile is found exactly once.
+  for (size_t i = 0; i < boundary.size (); ++i)
+  {
+    uint32_t x, y, z;
+    unpackVoxelKey (boundary[i].first, x, y, z);
+    for (size_t j = 0; j < 26; ++j)
+    {
+      const int sign = j < 13 ? 1 : -1;
+      const uint32_t nx = x + sign * HALF_STENCIL[j % 13][0];
+      const uint32_t ny = y + sign * HALF_STENCIL[j % 13][1];
+      const uint32_t nz = z + sign * HALF_STENCIL[j % 13][2];
+      // Negative coordinates wrap around and are caught here as well
+      if (nx >= MAX_VOXEL_KEY || ny >= MAX_VOXEL_KEY || nz >= MAX_VOXEL_KEY)
+        continue;
+      const uint64_t key = packVoxelKey (nx, ny, nz);
+      size_t neighbor;
+      if (getTileKey (key) != tile && table.find (key, neighbor))
+      {
+        const uint64_t edge[2] = { neighbor, boundary[i].second };
+        edges.write (reinterpret_cast<const char*> (edge), sizeof (edge));
+        ++num_edges_;
+      }
+    }
+  }
+  return (edges.good ());
+}
+
+template <typename PointT, typename GraphT> uint64_t
+pcl::graph::TiledVoxelGridGraphBuilder<PointT, GraphT>::getTileKey (uint64_t voxel_key) const
+{
+  uint32_t x, y, z;
+  unpackVoxelKey (voxel_key, x, y, z);
+  return (packVoxelKey (x / tile_size_, y / tile_size_, z / tile_size_));
+}
+
+#endif /* PCL_GRAPH_IMPL_TILED_VOXEL_GRID_GRAPH_BUILDER_HPP */
+
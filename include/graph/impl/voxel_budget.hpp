@@ -0,0 +1,215 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_VOXEL_BUDGET_HPP
+#define PCL_GRAPH_IMPL_VOXEL_BUDGET_HPP
+
+#include <cmath>
+
+#include <pcl/common/point_tests.h>
+
+#include "graph/voxel_hash.h"
+#include "graph/voxel_budget.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    namespace detail
+    {
+
+      /** Compute the packed key of the voxel that contains a point.
+        *
+        * \return \c false if the point is outside of the supported range */
+      template <typename PointT> inline bool
+      computeGridVoxelKey (const PointT& p, const Eigen::Vector3d& origin, double resolution, uint64_t& key)
+      {
+        const double x = std::floor ((p.x - origin[0]) / resolution);
+        const double y = std::floor ((p.y - origin[1]) / resolution);
+        const double z = std::floor ((p.z - origin[2]) / resolution);
+        const double max = MAX_VOXEL_KEY;
+        if (!(x >= 0 && y >= 0 && z >= 0 && x < max && y < max && z < max))
+          return (false);
+        key = packVoxelKey (static_cast<uint32_t> (x), static_cast<uint32_t> (y), static_cast<uint32_t> (z));
+        return (true);
+      }
+
+      /** Function object that counts the voxels occupied by the points for
+        * computeBudgetedVoxelResolution(), the grid has a fixed origin. */
+      template <typename PointT>
+      struct GridVoxelCounter
+      {
+
+        GridVoxelCounter (const pcl::PointCloud<PointT>& cloud,
+                          const std::vector<int>& indices,
+                          const Eigen::Vector3d& origin)
+        : cloud_ (cloud)
+        , indices_ (indices)
+        , origin_ (origin)
+        {
+        }
+
+        size_t
+        operator () (float resolution, size_t limit) const
+        {
+          return (countOccupiedVoxels (cloud_, indices_, origin_, resolution, limit));
+        }
+
+        const pcl::PointCloud<PointT>& cloud_;
+        const std::vector<int>& indices_;
+        const Eigen::Vector3d origin_;
+
+      };
+
+    }
+
+  }
+
+}
+
+template <typename PointT> size_t
+pcl::graph::countOccupiedVoxels (const pcl::PointCloud<PointT>& cloud,
+                                 const std::vector<int>& indices,
+                                 const Eigen::Vector3d& origin,
+                                 double resolution,
+                                 size_t limit)
+{
+  VoxelHashTable table (std::min (indices.size (), limit + 1));
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    const PointT& p = cloud.points[indices[i]];
+    if (!pcl::isFinite (p))
+      continue;
+    uint64_t key;
+    if (!detail::computeGridVoxelKey (p, origin, resolution, key))
+      return (std::numeric_limits<size_t>::max ());
+    table.insert (key, 0);
+    if (table.size () > limit)
+      break;
+  }
+  return (table.size ());
+}
+
+template <typename CountFunction> float
+pcl::graph::computeBudgetedVoxelResolution (float min_resolution,
+                                            size_t max_voxels,
+                                            CountFunction count_voxels,
+                                            float precision)
+{
+  if (count_voxels (min_resolution, max_voxels) <= max_voxels)
+    return (min_resolution);
+
+  // Invariant: "fine" exceeds the budget, "coarse" meets it.
+  float fine = min_resolution;
+  float coarse = 2.0f * min_resolution;
+  while (count_voxels (coarse, max_voxels) > max_voxels)
+  {
+    fine = coarse;
+    coarse *= 2.0f;
+  }
+  while (coarse > fine * (1.0f + precision))
+  {
+    const float middle = std::sqrt (fine * coarse);
+    if (count_voxels (middle, max_voxels) > max_voxels)
+      fine = middle;
+    else
+      coarse = middle;
+  }
+  return (coarse);
+}
+
+template <typename PointT> void
+pcl::graph::selectVoxelRepresentatives (const pcl::PointCloud<PointT>& cloud,
+                                        const std::vector<int>& indices,
+                                        const Eigen::Vector3d& origin,
+                                        double resolution,
+                                        std::vector<int>& representatives,
+                                        std::vector<size_t>& voxels)
+{
+  // Compute the keys and the (squared) distances to voxel centers in
+  // parallel, then number the voxels and pick the closest points serially.
+  std::vector<uint64_t> keys (indices.size ());
+  std::vector<double> distances (indices.size ());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int> (indices.size ()); ++i)
+  {
+    const PointT& p = cloud.points[indices[i]];
+    if (!detail::computeGridVoxelKey (p, origin, resolution, keys[i]))
+      keys[i] = std::numeric_limits<uint64_t>::max ();
+    const Eigen::Vector3d offset ((p.x - origin[0]) / resolution,
+                                  (p.y - origin[1]) / resolution,
+                                  (p.z - origin[2]) / resolution);
+    distances[i] = (offset.array () - offset.array ().floor () - 0.5).matrix ().squaredNorm ();
+  }
+
+  VoxelHashTable table (indices.size ());
+  std::vector<double> best_distances;
+  representatives.clear ();
+  voxels.resize (indices.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    size_t voxel;
+    if (keys[i] == std::numeric_limits<uint64_t>::max ())
+    {
+      // Should not happen for finite points within the grid, but keep the
+      // point on its own rather than dropping it
+      voxel = representatives.size ();
+      representatives.push_back (indices[i]);
+      best_distances.push_back (distances[i]);
+    }
+    else if (!table.find (keys[i], voxel))
+    {
+      voxel = representatives.size ();
+      table.insert (keys[i], voxel);
+      representatives.push_back (indices[i]);
+      best_distances.push_back (distances[i]);
+    }
+    else if (distances[i] < best_distances[voxel])
+    {
+      representatives[voxel] = indices[i];
+      best_distances[voxel] = distances[i];
+    }
+    voxels[i] = voxel;
+  }
+}
+
+#endif /* PCL_GRAPH_IMPL_VOXEL_BUDGET_HPP */
+
@@ -38,13 +38,18 @@
 #ifndef PCL_GRAPH_IMPL_VOXEL_GRID_GRAPH_BUILDER_HPP
 #define PCL_GRAPH_IMPL_VOXEL_GRID_GRAPH_BUILDER_HPP
 
+#include <algorithm>
+
 #include <boost/unordered_map.hpp>
 
-#include <pcl/common/io.h>
 #include <pcl/common/common.h>
 #include <pcl/common/centroid.h>
 #include <pcl/octree/octree_impl.h>
 
+#include "graph/utils.h"
+#include "graph/voxel_hash.h"
+#include "graph/voxel_budget.h"
+#include "graph/arena_allocator.h"
 #include "graph/voxel_grid_graph_builder.h"
 
 /* The function below is required in order to use boost::unordered_map with
@@ -57,7 +62,8 @@ namespace pcl
   namespace octree
   {
 
-    static size_t hash_value (const OctreeKey& b)
+    inline size_t
+    hash_value (const OctreeKey& b)
     {
       return boost::hash_value (b.key_);
     }
@@ -66,6 +72,347 @@ namespace pcl
 
 }
 
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    namespace detail
+    {
+
+      /** A pair of a Morton code of a voxel key and an index of a point that
+        * falls into the voxel. */
+      struct KeyIndexPair
+      {
+        uint64_t code;
+        int index;
+      };
+
+      /** Non-finite points are marked with the maximum code. */
+      inline bool
+      isNonFinitePair (const KeyIndexPair& pair)
+      {
+        return (pair.code == std::numeric_limits<uint64_t>::max ());
+      }
+
+      /** Sort (code, index) pairs by code with a least significant digit
+        * radix sort.
+        *
+        * The sort is stable, i.e. pairs with equal codes retain their relative
+        * order. Each pass is done in parallel: the input is split into
+        * contiguous chunks, per-chunk digit histograms are computed, and the
+        * pairs are scattered to offsets that are derived from the histograms
+        * in chunk order.
+        *
+        * \param[in,out] data pairs to sort
+        * \param[in]     num_bits number of lower bits of the codes that may be
+        *                non-zero */
+      inline void
+      radixSort (std::vector<KeyIndexPair>& data, unsigned int num_bits)
+      {
+        const unsigned int DIGIT_BITS = 8;
+        const size_t NUM_BUCKETS = 1 << DIGIT_BITS;
+        const int num_chunks = getMaxNumberOfThreads ();
+        std::vector<KeyIndexPair> buffer (data.size ());
+        std::vector<size_t> offsets (num_chunks * NUM_BUCKETS);
+        for (unsigned int shift = 0; shift < num_bits; shift += DIGIT_BITS)
+        {
+          std::fill (offsets.begin (), offsets.end (), 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static, 1)
+#endif
+          for (int c = 0; c < num_chunks; ++c)
+          {
+            std::pair<size_t, size_t> range = getChunkRange (c, num_chunks, data.size ());
+            size_t* histogram = &offsets[c * NUM_BUCKETS];
+            for (size_t i = range.first; i < range.second; ++i)
+              ++histogram[(data[i].code >> shift) & (NUM_BUCKETS - 1)];
+          }
+          size_t offset = 0;
+          for (size_t d = 0; d < NUM_BUCKETS; ++d)
+            for (int c = 0; c < num_chunks; ++c)
+            {
+              size_t count = offsets[c * NUM_BUCKETS + d];
+              offsets[c * NUM_BUCKETS + d] = offset;
+              offset += count;
+            }
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static, 1)
+#endif
+          for (int c = 0; c < num_chunks; ++c)
+          {
+            std::pair<size_t, size_t> range = getChunkRange (c, num_chunks, data.size ());
+            size_t* position = &offsets[c * NUM_BUCKETS];
+            for (size_t i = range.first; i < range.second; ++i)
+              buffer[position[(data[i].code >> shift) & (NUM_BUCKETS - 1)]++] = data[i];
+          }
+          data.swap (buffer);
+        }
+      }
+
+      /** Extract XYZ coordinates of the points of a cloud into a compact
+        * cloud, optionally transforming them to (x/z, y/z, log z) space.
+        *
+        * The points are processed in blocks: coordinates are gathered into
+        * contiguous arrays, so that division and logarithm are computed by
+        * Eigen's vectorized kernels, and then scattered to the output. The
+        * blocks are processed in parallel. */
+      template <typename PointT> void
+      transformPoints (const pcl::PointCloud<PointT>& input,
+                       bool use_transform,
+                       pcl::PointCloud<pcl::PointXYZ>& output)
+      {
+        typedef Eigen::Array<float, 256, 1> Block;
+        const int BLOCK_SIZE = Block::RowsAtCompileTime;
+        const int size = static_cast<int> (input.size ());
+        output.points.resize (size);
+        output.width = input.width;
+        output.height = input.height;
+        output.is_dense = input.is_dense;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int begin = 0; begin < size; begin += BLOCK_SIZE)
+        {
+          const int n = std::min (BLOCK_SIZE, size - begin);
+          Block x, y, z;
+          for (int i = 0; i < n; ++i)
+          {
+            const PointT& p = input.points[begin + i];
+            x[i] = p.x;
+            y[i] = p.y;
+            z[i] = p.z;
+          }
+          if (use_transform)
+          {
+            x.head (n) /= z.head (n);
+            y.head (n) /= z.head (n);
+            z.head (n) = z.head (n).log ();
+          }
+          for (int i = 0; i < n; ++i)
+          {
+            pcl::PointXYZ& p = output.points[begin + i];
+            p.x = x[i];
+            p.y = y[i];
+            p.z = z[i];
+          }
+        }
+      }
+
+      /** Compute the Morton code of an octree key such that sorting by codes
+        * gives the order in which octree::OctreePointCloud visits its leaves
+        * (the x bit is the most significant one in each triple). */
+      inline uint64_t
+      octreeMortonCode (uint32_t x, uint32_t y, uint32_t z)
+      {
+        return (mortonCode (z, y, x));
+      }
+
+      /** Compute Morton codes of the voxel keys of the (finite) points of a
+        * transformed cloud and sort (code, point index) pairs by codes.
+        *
+        * The voxel keys are computed with respect to the bounding box and
+        * depth of an octree::OctreePointCloud with the given resolution and
+        * bounding box, so they are exactly the same as the keys of its
+        * leaves. Returns \c false if this can not be guaranteed, i.e. if the
+        * octree would have to be deeper than 21 levels or expanded after
+        * construction.
+        *
+        * \param[in]  transformed transformed cloud (see transformPoints())
+        * \param[in]  indices indices of the points to voxelize
+        * \param[in]  min, max bounding box of the points
+        * \param[in]  voxel_resolution resolution of the voxel grid
+        * \param[out] pairs sorted (code, point index) pairs
+        * \param[out] depth depth of the octree */
+      inline bool
+      computeSortedVoxelCodes (const pcl::PointCloud<pcl::PointXYZ>& transformed,
+                               const std::vector<int>& indices,
+                               const Eigen::Vector4f& min,
+                               const Eigen::Vector4f& max,
+                               float voxel_resolution,
+                               std::vector<KeyIndexPair>& pairs,
+                               unsigned int& depth)
+      {
+        // Let the octree compute its depth and (centered) bounding box, so
+        // that the voxel keys are exactly the same as the keys of its leaves.
+        typedef pcl::octree::OctreePointCloud<pcl::PointXYZ> Octree;
+        Octree octree (voxel_resolution);
+        octree.defineBoundingBox (min (0), min (1), min (2), max (0), max (1), max (2));
+        depth = octree.getTreeDepth ();
+        if (depth > 21)
+          return (false);
+        double min_x, min_y, min_z, max_x, max_y, max_z;
+        octree.getBoundingBox (min_x, min_y, min_z, max_x, max_y, max_z);
+        const double resolution = octree.getResolution ();
+        const uint32_t num_keys = 1u << depth;
+
+        // Compute voxel keys of all (finite) points.
+        pairs.resize (indices.size ());
+        bool out_of_bounds = false;
+#ifdef _OPENMP
+#pragma omp parallel for reduction (||:out_of_bounds)
+#endif
+        for (int i = 0; i < static_cast<int> (indices.size ()); ++i)
+        {
+          const pcl::PointXYZ& p = transformed.points[indices[i]];
+          pairs[i].index = indices[i];
+          if (!pcl::isFinite (p))
+          {
+            pairs[i].code = std::numeric_limits<uint64_t>::max ();
+            continue;
+          }
+          const uint32_t x = static_cast<uint32_t> ((p.x - min_x) / resolution);
+          const uint32_t y = static_cast<uint32_t> ((p.y - min_y) / resolution);
+          const uint32_t z = static_cast<uint32_t> ((p.z - min_z) / resolution);
+          if (x >= num_keys || y >= num_keys || z >= num_keys)
+            out_of_bounds = true;
+          pairs[i].code = octreeMortonCode (x, y, z);
+        }
+
+        // The octree would have been expanded to accommodate some points
+        if (out_of_bounds)
+          return (false);
+
+        // Drop non-finite points and sort pairs by codes.
+        pairs.erase (std::remove_if (pairs.begin (), pairs.end (), isNonFinitePair), pairs.end ());
+        radixSort (pairs, 3 * depth);
+        return (true);
+      }
+
+      /** Function object that counts the voxels occupied by the points for
+        * computeBudgetedVoxelResolution(). The grid is aligned with the
+        * (centered) bounding box of the octree, so the counts are exactly
+        * the numbers of voxels that either voxelization method produces. */
+      struct OctreeVoxelCounter
+      {
+
+        OctreeVoxelCounter (const pcl::PointCloud<pcl::PointXYZ>& transformed,
+                            const std::vector<int>& indices,
+                            const Eigen::Vector4f& min,
+                            const Eigen::Vector4f& max)
+        : transformed_ (transformed)
+        , indices_ (indices)
+        , min_ (min)
+        , max_ (max)
+        {
+        }
+
+        size_t
+        operator () (float resolution, size_t limit) const
+        {
+          pcl::octree::OctreePointCloud<pcl::PointXYZ> octree (resolution);
+          octree.defineBoundingBox (min_ (0), min_ (1), min_ (2), max_ (0), max_ (1), max_ (2));
+          if (octree.getTreeDepth () > 21)
+            return (std::numeric_limits<size_t>::max ());
+          double min_x, min_y, min_z, max_x, max_y, max_z;
+          octree.getBoundingBox (min_x, min_y, min_z, max_x, max_y, max_z);
+          return (countOccupiedVoxels (transformed_, indices_, Eigen::Vector3d (min_x, min_y, min_z), octree.getResolution (), limit));
+        }
+
+        const pcl::PointCloud<pcl::PointXYZ>& transformed_;
+        const std::vector<int>& indices_;
+        const Eigen::Vector4f min_;
+        const Eigen::Vector4f max_;
+
+      };
+
+      /** Connect the vertices of a graph that correspond to adjacent voxels
+        * (26-neighborhood).
+        *
+        * The voxel keys are put in a VoxelHashTable and the forward half of
+        * the neighborhood (HALF_STENCIL) of every voxel is probed, which
+        * finds each adjacency exactly once regardless of the order of the
+        * voxels. The probing is done in parallel (one chunk of voxels per
+        * thread), the edges are then inserted in voxel order.
+        *
+        * \param[in]     voxel_keys packed keys (see packVoxelKey()), one per
+        *                vertex of the graph
+        * \param[in,out] graph a graph to add edges to */
+      template <typename Graph> void
+      addVoxelAdjacencyEdges (const std::vector<uint64_t>& voxel_keys, Graph& graph)
+      {
+        typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+        typedef std::vector<std::pair<VertexId, VertexId> > EdgeVector;
+
+        VoxelHashTable table (voxel_keys.size ());
+        for (size_t i = 0; i < voxel_keys.size (); ++i)
+          table.insert (voxel_keys[i], i);
+
+        const int num_chunks = getMaxNumberOfThreads ();
+        std::vector<EdgeVector> chunk_edges (num_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static, 1)
+#endif
+        for (int c = 0; c < num_chunks; ++c)
+        {
+          std::pair<size_t, size_t> range = getChunkRange (c, num_chunks, voxel_keys.size ());
+          EdgeVector& edges = chunk_edges[c];
+          edges.reserve (13 * (range.second - range.first));
+          for (VertexId v = range.first; v < range.second; ++v)
+          {
+            uint32_t x, y, z;
+            unpackVoxelKey (voxel_keys[v], x, y, z);
+            for (size_t i = 0; i < 13; ++i)
+            {
+              const uint32_t nx = x + HALF_STENCIL[i][0];
+              const uint32_t ny = y + HALF_STENCIL[i][1];
+              const uint32_t nz = z + HALF_STENCIL[i][2];
+              // Negative coordinates wrap around and are caught here as well
+              if (nx >= MAX_VOXEL_KEY || ny >= MAX_VOXEL_KEY || nz >= MAX_VOXEL_KEY)
+                continue;
+              size_t neighbor;
+              if (table.find (packVoxelKey (nx, ny, nz), neighbor))
+                edges.push_back (std::make_pair (v, static_cast<VertexId> (neighbor)));
+            }
+          }
+        }
+
+        for (int c = 0; c < num_chunks; ++c)
+          for (size_t i = 0; i < chunk_edges[c].size (); ++i)
+            boost::add_edge (chunk_edges[c][i].first, chunk_edges[c][i].second, graph);
+      }
+
+      /** Same as addVoxelAdjacencyEdges(), but for voxel grids that are too
+        * large for the packed keys (more than 2^21 voxels along some axis).
+        *
+        * The octree keys are put in a hash map and probed serially, which is
+        * slower but has no limit on the grid size.
+        *
+        * \param[in]     keys octree keys, one per vertex of the graph
+        * \param[in,out] graph a graph to add edges to */
+      template <typename Graph> void
+      addOctreeKeyAdjacencyEdges (const std::vector<pcl::octree::OctreeKey>& keys, Graph& graph)
+      {
+        typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+        typedef boost::unordered_map<pcl::octree::OctreeKey, VertexId> KeyVertexMap;
+
+        KeyVertexMap key_to_vertex_map (keys.size ());
+        for (VertexId v = 0; v < keys.size (); ++v)
+          key_to_vertex_map[keys[v]] = v;
+
+        for (VertexId v = 0; v < keys.size (); ++v)
+        {
+          for (size_t i = 0; i < 13; ++i)
+          {
+            // Negative coordinates wrap around and are not found in the map
+            pcl::octree::OctreeKey neighbor_key;
+            neighbor_key.x = static_cast<uint32_t> (keys[v].x + HALF_STENCIL[i][0]);
+            neighbor_key.y = static_cast<uint32_t> (keys[v].y + HALF_STENCIL[i][1]);
+            neighbor_key.z = static_cast<uint32_t> (keys[v].z + HALF_STENCIL[i][2]);
+            typename KeyVertexMap::const_iterator f = key_to_vertex_map.find (neighbor_key);
+            if (f != key_to_vertex_map.end ())
+              boost::add_edge (v, f->second, graph);
+          }
+        }
+      }
+
+    }
+
+  }
+
+}
+
 template <typename PointT, typename GraphT> void
 pcl::graph::VoxelGridGraphBuilder<PointT, GraphT>::compute (GraphT& graph)
 {
@@ -76,34 +423,56 @@ pcl::graph::VoxelGridGraphBuilder<PointT, GraphT>::compute (GraphT& graph)
     return;
   }
 
-  typename pcl::PointCloud<PointT>::Ptr transformed (new pcl::PointCloud<PointT>);
-  pcl::copyPointCloud (*input_, *transformed);
-  for (size_t i = 0; i < transformed->size (); ++i)
-  {
-    PointT& p = transformed->points[i];
-    p.x /= p.z;
-    p.y /= p.z;
-    p.z = std::log (p.z);
-  }
+  TransformedCloudPtr transformed (new TransformedCloud);
+  detail::transformPoints (*input_, use_transform_, *transformed);
 
   Eigen::Vector4f min, max;
   pcl::getMinMax3D (*transformed, *indices_, min, max);
 
+  effective_resolution_ = voxel_resolution_;
+  if (max_num_vertices_ > 0)
+  {
+    detail::OctreeVoxelCounter counter (*transformed, *indices_, min, max);
+    effective_resolution_ = computeBudgetedVoxelResolution (voxel_resolution_, max_num_vertices_, counter);
+  }
+
+  if (voxelization_method_ != VOXELIZATION_SORT || !computeSortBased (transformed, min, max, graph))
+    computeOctreeBased (transformed, min, max, graph);
+
+  this->applyVertexOrdering (graph);
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::VoxelGridGraphBuilder<PointT, GraphT>::computeOctreeBased (const TransformedCloudPtr& transformed,
+                                                                       const Eigen::Vector4f& min,
+                                                                       const Eigen::Vector4f& max,
+                                                                       GraphT& graph)
+{
   // Create and initialize an Octree that stores point indices
-  typedef pcl::octree::OctreePointCloud<PointT> Octree;
-  Octree octree (voxel_resolution_);
+  typedef pcl::octree::OctreePointCloud<pcl::PointXYZ> Octree;
+  Octree octree (effective_resolution_);
   octree.defineBoundingBox (min (0), min (1), min (2), max (0), max (1), max (2));
   octree.setInputCloud (transformed, indices_);
   octree.addPointsFromInputCloud ();
 
-  graph = GraphT (octree.getLeafCount ());
+  // Packed voxel keys have 21 bits per axis, deeper trees fall back to
+  // looking up the octree keys in a hash map.
+  const bool packed = octree.getTreeDepth () <= 21;
+
+  // Each voxel has at most 26 neighbors, in a typical surface scan about a
+  // half of them are occupied. If the graph type supports it, adjacency
+  // storage will be allocated in a single arena sized accordingly.
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (13 * octree.getLeafCount ()))));
 
-  typedef boost::unordered_map<pcl::octree::OctreeKey, VertexId> KeyVertexMap;
-  KeyVertexMap key_to_vertex_map;
+  graph = GraphT (octree.getLeafCount ());
+  bindEdgeListToCurrentArena (graph);
 
   point_to_vertex_map_.clear ();
   point_to_vertex_map_.resize (transformed->size (), std::numeric_limits<VertexId>::max ());
 
+  std::vector<uint64_t> voxel_keys (packed ? octree.getLeafCount () : 0);
+  std::vector<pcl::octree::OctreeKey> octree_keys (packed ? 0 : octree.getLeafCount ());
+
   typename Octree::LeafNodeIterator leaf_itr = octree.leaf_begin ();
   for (VertexId v = 0; leaf_itr != octree.leaf_end (); ++leaf_itr, ++v)
   {
@@ -118,28 +487,87 @@ pcl::graph::VoxelGridGraphBuilder<PointT, GraphT>::compute (GraphT& graph)
     }
     centroid.get (graph[v]);
 
-    // Step 2: fill in octree key to vertex map.
+    // Step 2: remember the voxel key of the leaf.
     octree::OctreeKey key = leaf_itr.getCurrentOctreeKey ();
-    key_to_vertex_map[key] = v;
+    if (packed)
+      voxel_keys[v] = packVoxelKey (key.x, key.y, key.z);
+    else
+      octree_keys[v] = key;
+  }
 
-    // Step 2: find neighbors and insert edges.
-    octree::OctreeKey neighbor_key;
-    for (int dx = (key.x > 0) ? -1 : 0; dx <= 1; ++dx)
+  // Step 3: find neighbors and insert edges.
+  if (packed)
+    detail::addVoxelAdjacencyEdges (voxel_keys, graph);
+  else
+    detail::addOctreeKeyAdjacencyEdges (octree_keys, graph);
+}
+
+template <typename PointT, typename GraphT> bool
+pcl::graph::VoxelGridGraphBuilder<PointT, GraphT>::computeSortBased (const TransformedCloudPtr& transformed,
+                                                                     const Eigen::Vector4f& min,
+                                                                     const Eigen::Vector4f& max,
+                                                                     GraphT& graph)
+{
+  using namespace detail;
+
+  // Step 1 and 2: compute voxel keys of all (finite) points and sort pairs
+  // by codes.
+  std::vector<KeyIndexPair> pairs;
+  unsigned int depth;
+  if (!computeSortedVoxelCodes (*transformed, *indices_, min, max, effective_resolution_, pairs, depth))
+    return (false);
+
+  // Step 3: find runs of equal codes, each run is a voxel.
+  std::vector<size_t> run_begin;
+  std::vector<uint64_t> voxel_codes;
+  for (size_t i = 0; i < pairs.size (); ++i)
+  {
+    if (i == 0 || pairs[i].code != pairs[i - 1].code)
     {
-      neighbor_key.x = static_cast<uint32_t> (key.x + dx);
-      for (int dy = (key.y > 0) ? -1 : 0; dy <= 1; ++dy)
-      {
-        neighbor_key.y = static_cast<uint32_t> (key.y + dy);
-        for (int dz = (key.z > 0) ? -1 : 0; dz <= 1; ++dz)
-        {
-          neighbor_key.z = static_cast<uint32_t> (key.z + dz);
-          typename KeyVertexMap::iterator f = key_to_vertex_map.find (neighbor_key);
-          if (f != key_to_vertex_map.end () && v != f->second)
-            boost::add_edge (v, f->second, graph);
-        }
-      }
+      run_begin.push_back (i);
+      voxel_codes.push_back (pairs[i].code);
+    }
+  }
+  run_begin.push_back (pairs.size ());
+  const size_t num_voxels = voxel_codes.size ();
+
+  ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (13 * num_voxels))));
+
+  graph = GraphT (num_voxels);
+  bindEdgeListToCurrentArena (graph);
+
+  point_to_vertex_map_.clear ();
+  point_to_vertex_map_.resize (transformed->size (), std::numeric_limits<VertexId>::max ());
+
+  // Step 4: reduce runs into centroids and fill in the point to vertex map.
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int> (num_voxels); ++i)
+  {
+    const VertexId v = i;
+    pcl::CentroidPoint<PointInT> centroid;
+    for (size_t j = run_begin[v]; j < run_begin[v + 1]; ++j)
+    {
+      centroid.add (input_->operator[] (pairs[j].index));
+      point_to_vertex_map_[pairs[j].index] = v;
     }
+    centroid.get (graph[v]);
+  }
+
+  // Step 5: find neighbors and insert edges.
+  std::vector<uint64_t> voxel_keys (num_voxels);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int> (num_voxels); ++i)
+  {
+    const uint64_t code = voxel_codes[i];
+    voxel_keys[i] = packVoxelKey (compactBits3 (code >> 2), compactBits3 (code >> 1), compactBits3 (code));
   }
+  addVoxelAdjacencyEdges (voxel_keys, graph);
+
+  return (true);
 }
 
 #endif /* PCL_GRAPH_IMPL_VOXEL_GRID_GRAPH_BUILDER_HPP */
@@ -0,0 +1,313 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_IMPL_VOXEL_GRID_GRAPH_PYRAMID_BUILDER_HPP
+#define PCL_GRAPH_IMPL_VOXEL_GRID_GRAPH_PYRAMID_BUILDER_HPP
+
+#include <boost/unordered_map.hpp>
+#include <boost/fusion/include/find.hpp>
+#include <boost/fusion/include/for_each.hpp>
+
+#include <pcl/console/print.h>
+#include <pcl/common/common.h>
+#include <pcl/common/centroid.h>
+#include <pcl/common/impl/accumulators.hpp>
+
+#include "graph/voxel_grid_graph_builder.h"
+#include "graph/voxel_grid_graph_pyramid_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    namespace detail
+    {
+
+      /* Merging of the centroid accumulators (the ones pcl::CentroidPoint
+       * uses), so that the centroids of coarser voxels can be obtained from
+       * the accumulated sums of their children. */
+
+      inline void
+      merge (pcl::detail::AccumulatorXYZ& a, const pcl::detail::AccumulatorXYZ& b)
+      {
+        a.xyz += b.xyz;
+      }
+
+      inline void
+      merge (pcl::detail::AccumulatorNormal& a, const pcl::detail::AccumulatorNormal& b)
+      {
+        a.normal += b.normal;
+      }
+
+      inline void
+      merge (pcl::detail::AccumulatorCurvature& a, const pcl::detail::AccumulatorCurvature& b)
+      {
+        a.curvature += b.curvature;
+      }
+
+      inline void
+      merge (pcl::detail::AccumulatorRGBA& a, const pcl::detail::AccumulatorRGBA& b)
+      {
+        a.r += b.r;
+        a.g += b.g;
+        a.b += b.b;
+        a.a += b.a;
+      }
+
+      inline void
+      merge (pcl::detail::AccumulatorIntensity& a, const pcl::detail::AccumulatorIntensity& b)
+      {
+        a.intensity += b.intensity;
+      }
+
+      inline void
+      merge (pcl::detail::AccumulatorLabel& a, const pcl::detail::AccumulatorLabel& b)
+      {
+        for (boost::unordered_map<uint32_t, size_t>::const_iterator itr = b.labels.begin (); itr != b.labels.end (); ++itr)
+          a.labels[itr->first] += itr->second;
+      }
+
+      template <typename AccumulatorsT>
+      struct MergeAccumulators
+      {
+        MergeAccumulators (const AccumulatorsT& source) : source_ (source) { }
+
+        template <typename AccumulatorT> void
+        operator () (AccumulatorT& accumulator) const
+        {
+          merge (accumulator, *boost::fusion::find<AccumulatorT> (source_));
+        }
+
+        const AccumulatorsT& source_;
+      };
+
+    }
+
+  }
+
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::VoxelGridGraphPyramidBuilder<PointT, GraphT>::compute (GraphT& graph)
+{
+  if (!initCompute ())
+  {
+    graph = GraphT ();
+    deinitCompute ();
+    return;
+  }
+
+  std::vector<GraphPtr> coarser;
+  if (!computeLevels (1, graph, coarser))
+  {
+    graph = GraphT ();
+    point_to_vertex_map_.assign (input_->size (), std::numeric_limits<VertexId>::max ());
+    deinitCompute ();
+    return;
+  }
+
+  this->applyVertexOrdering (graph);
+  deinitCompute ();
+}
+
+template <typename PointT, typename GraphT> void
+pcl::graph::VoxelGridGraphPyramidBuilder<PointT, GraphT>::compute (std::vector<GraphPtr>& levels)
+{
+  levels.clear ();
+  if (!initCompute ())
+  {
+    deinitCompute ();
+    return;
+  }
+
+  GraphPtr finest (new GraphT);
+  std::vector<GraphPtr> coarser;
+  if (computeLevels (std::max<size_t> (num_levels_, 1), *finest, coarser))
+  {
+    levels.push_back (finest);
+    levels.insert (levels.end (), coarser.begin (), coarser.end ());
+    this->computeVertexToPointsMap (boost::num_vertices (*finest));
+  }
+  else
+  {
+    point_to_vertex_map_.assign (input_->size (), std::numeric_limits<VertexId>::max ());
+  }
+
+  deinitCompute ();
+}
+
+template <typename PointT, typename GraphT> bool
+pcl::graph::VoxelGridGraphPyramidBuilder<PointT, GraphT>::computeLevels (size_t num_levels,
+                                                                         GraphT& finest,
+                                                                         std::vector<GraphPtr>& coarser)
+{
+  using namespace detail;
+
+  fine_to_coarse_.clear ();
+  children_offsets_.clear ();
+
+  pcl::PointCloud<pcl::PointXYZ> transformed;
+  transformPoints (*input_, use_transform_, transformed);
+  Eigen::Vector4f min, max;
+  pcl::getMinMax3D (transformed, *indices_, min, max);
+
+  // Voxelize and sort the points once, for the finest level.
+  std::vector<KeyIndexPair> pairs;
+  unsigned int depth;
+  if (!computeSortedVoxelCodes (transformed, *indices_, min, max, voxel_resolution_, pairs, depth))
+  {
+    PCL_ERROR ("[pcl::graph::VoxelGridGraphPyramidBuilder::compute] Voxel grid is too fine for the extent of the input cloud.\n");
+    return (false);
+  }
+  num_levels = std::min<size_t> (num_levels, depth + 1);
+
+  // Runs of points that belong to the voxels of the finest level.
+  std::vector<size_t> run_begin;
+  std::vector<uint64_t> voxel_codes;
+  for (size_t i = 0; i < pairs.size (); ++i)
+  {
+    if (i == 0 || pairs[i].code != pairs[i - 1].code)
+    {
+      run_begin.push_back (i);
+      voxel_codes.push_back (pairs[i].code);
+    }
+  }
+  run_begin.push_back (pairs.size ());
+
+  point_to_vertex_map_.clear ();
+  point_to_vertex_map_.resize (input_->size (), std::numeric_limits<VertexId>::max ());
+
+  // Centroid sums and point counts of the voxels of the current level. The
+  // points are only visited for the finest level, the voxels of coarser
+  // levels merge the sums of their children.
+  typedef typename pcl::detail::Accumulators<PointInT>::type AccumulatorsT;
+  typedef typename pcl::detail::Accumulators<PointInT, PointOutT>::type OutAccumulatorsT;
+  std::vector<AccumulatorsT, Eigen::aligned_allocator<AccumulatorsT> > sums;
+  std::vector<size_t> counts;
+
+  for (size_t level = 0; level < num_levels; ++level)
+  {
+    if (level > 0)
+    {
+      // Merge runs of the previous level whose codes share the prefix.
+      std::vector<size_t> offsets;
+      std::vector<uint64_t> codes;
+      std::vector<VertexId>& parents = fine_to_coarse_.back ();
+      parents.resize (voxel_codes.size ());
+      for (size_t i = 0; i < voxel_codes.size (); ++i)
+      {
+        const uint64_t code = voxel_codes[i] >> 3;
+        if (i == 0 || code != codes.back ())
+        {
+          offsets.push_back (i);
+          codes.push_back (code);
+        }
+        parents[i] = codes.size () - 1;
+      }
+      offsets.push_back (voxel_codes.size ());
+      voxel_codes.swap (codes);
+      children_offsets_.push_back (offsets);
+    }
+
+    const size_t num_voxels = voxel_codes.size ();
+    GraphT* graph = &finest;
+    ScopedArena arena (MonotonicArena::Ptr (new MonotonicArena (estimateArenaSize (13 * num_voxels))));
+    if (level == 0)
+    {
+      finest = GraphT (num_voxels);
+      bindEdgeListToCurrentArena (finest);
+    }
+    else
+    {
+      coarser.push_back (GraphPtr (new GraphT (num_voxels)));
+      graph = coarser.back ().get ();
+    }
+
+    // Accumulate the points of the finest voxels, or merge the sums of the
+    // children, and reduce them into centroids.
+    std::vector<AccumulatorsT, Eigen::aligned_allocator<AccumulatorsT> > level_sums (num_voxels);
+    std::vector<size_t> level_counts (num_voxels, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < static_cast<int> (num_voxels); ++i)
+    {
+      const VertexId v = i;
+      if (level == 0)
+      {
+        for (size_t j = run_begin[v]; j < run_begin[v + 1]; ++j)
+        {
+          boost::fusion::for_each (level_sums[v], pcl::detail::AddPoint<PointInT> (input_->operator[] (pairs[j].index)));
+          point_to_vertex_map_[pairs[j].index] = v;
+        }
+        level_counts[v] = run_begin[v + 1] - run_begin[v];
+      }
+      else
+      {
+        const std::vector<size_t>& offsets = children_offsets_.back ();
+        for (size_t j = offsets[v]; j < offsets[v + 1]; ++j)
+        {
+          boost::fusion::for_each (level_sums[v], MergeAccumulators<AccumulatorsT> (sums[j]));
+          level_counts[v] += counts[j];
+        }
+      }
+      OutAccumulatorsT out (level_sums[v]);
+      boost::fusion::for_each (out, pcl::detail::GetPoint<PointOutT> ((*graph)[v], level_counts[v]));
+    }
+    sums.swap (level_sums);
+    counts.swap (level_counts);
+
+    // Find neighbors and insert edges.
+    std::vector<uint64_t> voxel_keys (num_voxels);
+    for (size_t i = 0; i < num_voxels; ++i)
+    {
+      const uint64_t code = voxel_codes[i];
+      voxel_keys[i] = packVoxelKey (compactBits3 (code >> 2), compactBits3 (code >> 1), compactBits3 (code));
+    }
+    addVoxelAdjacencyEdges (voxel_keys, *graph);
+
+    if (level + 1 < num_levels)
+      fine_to_coarse_.push_back (std::vector<VertexId> ());
+  }
+
+  return (true);
+}
+
+#endif /* PCL_GRAPH_IMPL_VOXEL_GRID_GRAPH_PYRAMID_BUILDER_HPP */
+
@@ -0,0 +1,256 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_INCREMENTAL_VOXEL_GRID_GRAPH_BUILDER_H
+#define PCL_GRAPH_INCREMENTAL_VOXEL_GRID_GRAPH_BUILDER_H
+
+#include "graph/graph_builder.h"
+#include "graph/voxel_hash.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** This class maintains a voxel grid graph over a stream of frames,
+      * updating it incrementally instead of rebuilding it from scratch.
+      *
+      * The points are transformed and partitioned into voxels in the same
+      * way as in VoxelGridGraphBuilder, except that the grid is anchored at
+      * a fixed origin (rather than at the bounding box of the current frame)
+      * so that voxel keys are stable between frames. Each occupied voxel
+      * corresponds to a vertex positioned at the centroid of its points, and
+      * vertices of adjacent voxels (26-neighborhood) are connected.
+      *
+      * The builder keeps the voxel hash table, the voxel of every input point,
+      * and a copy of the previous frame. When compute() is called with the
+      * same graph object as in the previous call and an input cloud of the
+      * same size, only the points that changed (moved to a different voxel,
+      * became invalid, or changed any of their fields) are removed from and
+      * inserted into their voxels. Then:
+      *
+      * - voxels that became empty release their vertices; such vertices are
+      *   disconnected but not removed from the graph, so that the ids of the
+      *   remaining vertices stay valid; they are reused for voxels that get
+      *   occupied later (see getRemovedVertices());
+      * - voxels that became occupied get a vertex and are connected with
+      *   their occupied neighbors;
+      * - centroids are recomputed only for the voxels that had points
+      *   inserted or removed.
+      *
+      * The vertices whose voxels changed and the edges incident to them are
+      * reported by getDirtyVertices() and getDirtyEdges(), so that subsequent
+      * stages (e.g. normal estimation and edge weighting) may restrict the
+      * processing to them. In all other cases (first frame, different graph,
+      * different cloud size, changed parameters, or after reset()) the graph
+      * is rebuilt and all vertices and edges are reported as dirty.
+      *
+      * \note The graph storage is not allocated in a MonotonicArena because
+      * the incremental updates would keep growing it. The vertex ordering
+      * (see setVertexOrdering()) is not applied, as it would invalidate the
+      * vertex ids between frames.
+      *
+      * For additional information see documentation for \ref GraphBuilder.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT, typename GraphT>
+    class PCL_EXPORTS IncrementalVoxelGridGraphBuilder : public GraphBuilder<PointT, GraphT>
+    {
+
+        using GraphBuilder<PointT, GraphT>::initCompute;
+        using PCLBase<PointT>::deinitCompute;
+        using PCLBase<PointT>::indices_;
+        using PCLBase<PointT>::input_;
+        using PCLBase<PointT>::fake_indices_;
+        using GraphBuilder<PointT, GraphT>::point_to_vertex_map_;
+
+      public:
+
+        using typename GraphBuilder<PointT, GraphT>::PointInT;
+        using typename GraphBuilder<PointT, GraphT>::PointOutT;
+        using typename GraphBuilder<PointT, GraphT>::VertexId;
+
+        typedef typename boost::graph_traits<GraphT>::edge_descriptor EdgeId;
+
+        /** Constructor.
+          *
+          * \param[in] voxel_resolution resolution of the voxel grid */
+        IncrementalVoxelGridGraphBuilder (float voxel_resolution)
+        : voxel_resolution_ (voxel_resolution)
+        , use_transform_ (true)
+        , voxel_table_ (0)
+        {
+          reset ();
+        }
+
+        /** Update the graph built for the previous frame (or build a new one)
+          * according to the current input cloud. */
+        virtual void
+        compute (GraphT& graph);
+
+        /** Forget the state kept from the previous frame, so that the next
+          * call to compute() rebuilds the graph from scratch. */
+        void
+        reset ();
+
+        inline void
+        setVoxelResolution (float resolution)
+        {
+          voxel_resolution_ = resolution;
+        }
+
+        inline float
+        getVoxelResolution () const
+        {
+          return (voxel_resolution_);
+        }
+
+        /** Set whether the points should be transformed to (x/z, y/z, log z)
+          * space before voxelization. */
+        inline void
+        setUseTransform (bool use_transform)
+        {
+          use_transform_ = use_transform;
+        }
+
+        inline bool
+        getUseTransform () const
+        {
+          return (use_transform_);
+        }
+
+        /** Get the vertices that were added or whose centroids changed during
+          * the last call to compute() (sorted by id). */
+        inline const std::vector<VertexId>&
+        getDirtyVertices () const
+        {
+          return (dirty_vertices_);
+        }
+
+        /** Get the edges that were added during the last call to compute()
+          * or are incident to the dirty vertices. */
+        inline const std::vector<EdgeId>&
+        getDirtyEdges () const
+        {
+          return (dirty_edges_);
+        }
+
+        /** Get the vertices that were released during the last call to
+          * compute() and not reused. These vertices have no edges and no
+          * points mapped to them. */
+        inline const std::vector<VertexId>&
+        getRemovedVertices () const
+        {
+          return (removed_vertices_);
+        }
+
+        /** Get all vertices that are currently not associated with any voxel
+          * (released in this or in one of the previous frames). */
+        inline const std::vector<VertexId>&
+        getFreeVertices () const
+        {
+          return (free_vertices_);
+        }
+
+      private:
+
+        struct Voxel
+        {
+          uint64_t key;
+          VertexId vertex;
+          size_t num_points;
+        };
+
+        /** Find the voxel with a given key, creating it if it does not
+          * exist. */
+        size_t
+        findOrCreateVoxel (uint64_t key);
+
+        /** Rebuild the hash table with (at least) a given capacity. */
+        void
+        rebuildVoxelTable (size_t capacity);
+
+        /** Drop empty voxels, update point to voxel indices, and rebuild the
+          * hash table. Must not be called in the middle of an update. */
+        void
+        compactVoxels ();
+
+        /// Resolution of the voxel grid.
+        float voxel_resolution_;
+
+        /// Whether the points are transformed before voxelization.
+        bool use_transform_;
+
+        /// Resolution and transform the current state was built with.
+        float state_resolution_;
+        bool state_use_transform_;
+
+        /// All voxels (some of them may be empty).
+        std::vector<Voxel> voxels_;
+
+        /// Maps voxel keys to indices in voxels_.
+        VoxelHashTable voxel_table_;
+        size_t voxel_table_capacity_;
+
+        /// Index of the voxel of each input point of the previous frame.
+        std::vector<size_t> point_voxels_;
+
+        /// Previous input frame.
+        pcl::PointCloud<PointInT> previous_;
+
+        /// Graph updated in the previous frame and its size at that time.
+        const GraphT* graph_;
+        size_t num_vertices_;
+        size_t num_edges_;
+
+        std::vector<VertexId> free_vertices_;
+        std::vector<VertexId> dirty_vertices_;
+        std::vector<VertexId> removed_vertices_;
+        std::vector<EdgeId> dirty_edges_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/incremental_voxel_grid_graph_builder.hpp"
+
+#endif /* PCL_GRAPH_INCREMENTAL_VOXEL_GRID_GRAPH_BUILDER_H */
+
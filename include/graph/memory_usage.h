@@ -0,0 +1,203 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_MEMORY_USAGE_H
+#define PCL_GRAPH_MEMORY_USAGE_H
+
+#include <string>
+#include <vector>
+
+#include <pcl/console/print.h>
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** A breakdown of the memory used by a data structure.
+      *
+      * The report is a list of named entries, each giving the number of bytes
+      * occupied by one of the constituent parts of the data structure (e.g.
+      * the point cloud, the out-edge lists, or a matrix). Optionally, the
+      * number of vertices and edges of the graph the structure relates to may
+      * be stored, in which case print() also outputs the per-vertex and
+      * per-edge memory cost.
+      *
+      * The numbers are estimates: the sizes of the elements and the capacity
+      * of the containers are taken into account, but the bookkeeping overhead
+      * of the heap allocator is not.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    class MemoryReport
+    {
+
+      public:
+
+        struct Entry
+        {
+          std::string name;
+          size_t bytes;
+        };
+
+        MemoryReport ()
+        : num_vertices_ (0)
+        , num_edges_ (0)
+        {
+        }
+
+        /** Add an entry to the report. */
+        inline void
+        add (const std::string& name, size_t bytes)
+        {
+          Entry entry = { name, bytes };
+          entries_.push_back (entry);
+        }
+
+        /** Add all entries of another report, prepending a prefix to their
+          * names. */
+        inline void
+        add (const std::string& prefix, const MemoryReport& report)
+        {
+          for (size_t i = 0; i < report.entries_.size (); ++i)
+            add (prefix + "/" + report.entries_[i].name, report.entries_[i].bytes);
+        }
+
+        inline const std::vector<Entry>&
+        getEntries () const
+        {
+          return (entries_);
+        }
+
+        /** Get the sum of the sizes of all entries. */
+        inline size_t
+        getTotalBytes () const
+        {
+          size_t total = 0;
+          for (size_t i = 0; i < entries_.size (); ++i)
+            total += entries_[i].bytes;
+          return (total);
+        }
+
+        inline void
+        setNumberOfVertices (size_t num_vertices)
+        {
+          num_vertices_ = num_vertices;
+        }
+
+        inline size_t
+        getNumberOfVertices () const
+        {
+          return (num_vertices_);
+        }
+
+        inline void
+        setNumberOfEdges (size_t num_edges)
+        {
+          num_edges_ = num_edges;
+        }
+
+        inline size_t
+        getNumberOfEdges () const
+        {
+          return (num_edges_);
+        }
+
+        /** Print the report to the console. */
+        void
+        print (const std::string& title) const
+        {
+          pcl::console::print_info ("%s:\n", title.c_str ());
+          for (size_t i = 0; i < entries_.size (); ++i)
+          {
+            pcl::console::print_info ("  %-40s ", entries_[i].name.c_str ());
+            pcl::console::print_value ("%12zu", entries_[i].bytes);
+            pcl::console::print_info (" bytes\n");
+          }
+          const size_t total = getTotalBytes ();
+          pcl::console::print_info ("  %-40s ", "total");
+          pcl::console::print_value ("%12zu", total);
+          pcl::console::print_info (" bytes (%.2f MB)\n", total / 1048576.0);
+          if (num_vertices_)
+          {
+            pcl::console::print_info ("  %-40s ", "per vertex");
+            pcl::console::print_value ("%12.1f", static_cast<double> (total) / num_vertices_);
+            pcl::console::print_info (" bytes\n");
+          }
+          if (num_edges_)
+          {
+            pcl::console::print_info ("  %-40s ", "per edge");
+            pcl::console::print_value ("%12.1f", static_cast<double> (total) / num_edges_);
+            pcl::console::print_info (" bytes\n");
+          }
+        }
+
+      private:
+
+        std::vector<Entry> entries_;
+        size_t num_vertices_;
+        size_t num_edges_;
+
+    };
+
+    /** Compute a report of the memory used by a point cloud graph.
+      *
+      * The report includes the point cloud, the vertex storage (including
+      * internal vertex properties), the out-edge lists, and the global edge
+      * list (including internal edge properties). For graphs that store
+      * adjacency in a MonotonicArena, the part of the arena that was reserved
+      * but not handed out is reported as well.
+      *
+      * In case of subgraphs the memory used by all children of the graph is
+      * included, one entry per child for the vertex and edge mappings and for
+      * their own copy of the adjacency structure.
+      *
+      * \c Graph has to be a model of concepts::PointCloudGraphConcept.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename Graph> MemoryReport
+    computeMemoryUsage (const Graph& graph);
+
+  }
+
+}
+
+#include "graph/impl/memory_usage.hpp"
+
+#endif /* PCL_GRAPH_MEMORY_USAGE_H */
@@ -0,0 +1,129 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_MESH_GRAPH_BUILDER_H
+#define PCL_GRAPH_MESH_GRAPH_BUILDER_H
+
+#include <pcl/Vertices.h>
+#include <pcl/PolygonMesh.h>
+
+#include "graph/graph_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** This class builds a point cloud graph from a polygonal mesh.
+      *
+      * The vertices of the mesh become vertices of the graph, and the sides
+      * of the polygons become edges. The input may be given either as a
+      * PolygonMesh (see setInputMesh()), or as a point cloud (see
+      * setInputCloud()) plus a list of polygons that refer to its points
+      * (see setPolygons()). If indices are given, only the polygon sides
+      * with both ends among them produce edges.
+      *
+      * If the output point type has normals, they are computed as the
+      * area-weighted average of the normals of the adjacent polygons. If it
+      * also has curvature, the curvature of a vertex is computed from the
+      * normals of its neighbors as
+      *
+      *   sum_j n_j . (p_i - p_j) / (0.001 * degree (i)).
+      *
+      * For additional information see documentation for \ref GraphBuilder.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT, typename GraphT>
+    class PCL_EXPORTS MeshGraphBuilder : public GraphBuilder<PointT, GraphT>
+    {
+
+        using GraphBuilder<PointT, GraphT>::initCompute;
+        using PCLBase<PointT>::deinitCompute;
+        using PCLBase<PointT>::indices_;
+        using PCLBase<PointT>::input_;
+        using GraphBuilder<PointT, GraphT>::point_to_vertex_map_;
+
+      public:
+
+        using typename GraphBuilder<PointT, GraphT>::PointInT;
+        using typename GraphBuilder<PointT, GraphT>::PointOutT;
+        using typename GraphBuilder<PointT, GraphT>::VertexId;
+
+        typedef boost::shared_ptr<const std::vector<pcl::Vertices> > PolygonsConstPtr;
+
+        MeshGraphBuilder ()
+        {
+        }
+
+        virtual void
+        compute (GraphT& graph);
+
+        /** Set the input mesh. The points of the mesh become the input cloud
+          * and the polygons are used to establish edges. */
+        void
+        setInputMesh (const pcl::PolygonMesh::ConstPtr& mesh);
+
+        /** Set the polygons (indices of their vertices in the input cloud). */
+        inline void
+        setPolygons (const PolygonsConstPtr& polygons)
+        {
+          polygons_ = polygons;
+        }
+
+        inline PolygonsConstPtr
+        getPolygons () const
+        {
+          return (polygons_);
+        }
+
+      private:
+
+        /// Polygons of the mesh.
+        PolygonsConstPtr polygons_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/mesh_graph_builder.hpp"
+
+#endif /* PCL_GRAPH_MESH_GRAPH_BUILDER_H */
+
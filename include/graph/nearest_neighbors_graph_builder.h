@@ -55,7 +55,9 @@ namespace pcl
       * established between each point and its neighbors (as found by the search
       * object provided with setSearchMethod()). The user may choose to use the
       * default search method, which will be either KdTree or OrganizedNeighbor
-      * depending on whether the input point cloud is organized or not.
+      * depending on whether the input point cloud is organized or not. For
+      * large unorganized clouds, where exact search is slow, ApproximateGridSearch
+      * may be supplied instead.
       *
       * The data contained in the points of the input cloud will be copied
       * inside the vertices of the newly created graph. Note that the points in
@@ -70,7 +72,7 @@ namespace pcl
     class PCL_EXPORTS NearestNeighborsGraphBuilder : public GraphBuilder<PointT, GraphT>
     {
 
-        using PCLBase<PointT>::initCompute;
+        using GraphBuilder<PointT, GraphT>::initCompute;
         using PCLBase<PointT>::deinitCompute;
         using PCLBase<PointT>::indices_;
         using PCLBase<PointT>::input_;
@@ -99,6 +101,7 @@ namespace pcl
           * adjust its parameters. */
         NearestNeighborsGraphBuilder ()
         : num_neighbors_ (10)
+        , max_num_vertices_ (0)
         , search_type_ (KNN)
         {
         }
@@ -152,6 +155,27 @@ namespace pcl
           radius_ = radius;
         }
 
+        /** Set the maximum number of vertices in the output graph (0 means
+          * no limit).
+          *
+          * If there are more input points than that, the points are binned
+          * into the finest voxel grid that has at most this many occupied
+          * voxels (see computeBudgetedVoxelResolution()), and only the point
+          * closest to the center of each voxel becomes a vertex. The other
+          * points are mapped to the vertex of their voxel in the point to
+          * vertex map. */
+        inline void
+        setMaxNumberOfVertices (size_t max_num_vertices)
+        {
+          max_num_vertices_ = max_num_vertices;
+        }
+
+        inline size_t
+        getMaxNumberOfVertices () const
+        {
+          return (max_num_vertices_);
+        }
+
       private:
 
         /// The search method that will be used for finding K nearest neighbors
@@ -164,6 +188,9 @@ namespace pcl
         /// Sphere radius for radius search.
         double radius_;
 
+        /// Maximum number of vertices in the output graph (0 = no limit).
+        size_t max_num_vertices_;
+
         /// Search type (knn or radius).
         SearchType search_type_;
 
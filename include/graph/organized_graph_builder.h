@@ -0,0 +1,169 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_ORGANIZED_GRAPH_BUILDER_H
+#define PCL_GRAPH_ORGANIZED_GRAPH_BUILDER_H
+
+#include "graph/graph_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** This class builds a BGL graph representing an organized input dataset
+      * by exploiting the pixel grid of the depth image it came from.
+      *
+      * Each finite pixel becomes a vertex and is connected with its 4 or 8
+      * image neighbors (see setConnectivity()). No spatial search structure
+      * is involved, so the graph is built in a single linear pass over the
+      * image. Neighboring pixels that lie on different sides of a depth
+      * discontinuity are not connected: an edge is only created if the depth
+      * difference between its endpoints does not exceed a given fraction of
+      * the smaller depth (see setDepthDiscontinuityThreshold()).
+      *
+      * Optionally the image may be partitioned into square bins of pixels
+      * (see setBinSize()). In this case each bin that contains at least one
+      * finite pixel becomes a vertex (positioned at the centroid of its
+      * points), and the bins are connected in the same way as the pixels.
+      *
+      * The input cloud is required to be organized, otherwise an empty graph
+      * is produced.
+      *
+      * For additional information see documentation for \ref GraphBuilder.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT, typename GraphT>
+    class PCL_EXPORTS OrganizedGraphBuilder : public GraphBuilder<PointT, GraphT>
+    {
+
+        using GraphBuilder<PointT, GraphT>::initCompute;
+        using PCLBase<PointT>::deinitCompute;
+        using PCLBase<PointT>::indices_;
+        using PCLBase<PointT>::input_;
+        using GraphBuilder<PointT, GraphT>::point_to_vertex_map_;
+
+      public:
+
+        using typename GraphBuilder<PointT, GraphT>::PointInT;
+        using typename GraphBuilder<PointT, GraphT>::PointOutT;
+        using typename GraphBuilder<PointT, GraphT>::VertexId;
+
+        /** Image neighborhoods that may be used to connect pixels. */
+        enum Connectivity
+        {
+          /// Left, right, top, and bottom neighbors.
+          CONNECTIVITY_4,
+          /// 4-neighborhood plus diagonal neighbors.
+          CONNECTIVITY_8
+        };
+
+        /** Constructor.
+          *
+          * \param[in] connectivity image neighborhood used to connect pixels
+          * \param[in] depth_threshold maximum relative depth difference between
+          * connected pixels */
+        OrganizedGraphBuilder (Connectivity connectivity = CONNECTIVITY_8,
+                               float depth_threshold = 0.05f)
+        : connectivity_ (connectivity)
+        , depth_threshold_ (depth_threshold)
+        , bin_size_ (1)
+        {
+        }
+
+        virtual void
+        compute (GraphT& graph);
+
+        inline void
+        setConnectivity (Connectivity connectivity)
+        {
+          connectivity_ = connectivity;
+        }
+
+        inline Connectivity
+        getConnectivity () const
+        {
+          return (connectivity_);
+        }
+
+        /** Set the maximum depth difference between two neighboring pixels
+          * (relative to the smaller of their depths) for them to be connected
+          * with an edge. */
+        inline void
+        setDepthDiscontinuityThreshold (float threshold)
+        {
+          depth_threshold_ = threshold;
+        }
+
+        inline float
+        getDepthDiscontinuityThreshold () const
+        {
+          return (depth_threshold_);
+        }
+
+        /** Set the size (in pixels) of the square bins the image is
+          * partitioned into. The default value 1 disables binning. */
+        inline void
+        setBinSize (unsigned int bin_size)
+        {
+          bin_size_ = bin_size > 0 ? bin_size : 1;
+        }
+
+        inline unsigned int
+        getBinSize () const
+        {
+          return (bin_size_);
+        }
+
+      private:
+
+        Connectivity connectivity_;
+        float depth_threshold_;
+        unsigned int bin_size_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/organized_graph_builder.hpp"
+
+#endif /* PCL_GRAPH_ORGANIZED_GRAPH_BUILDER_H */
+
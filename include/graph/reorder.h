@@ -0,0 +1,157 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_REORDER_H
+#define PCL_GRAPH_REORDER_H
+
+#include <vector>
+
+#include <boost/graph/graph_traits.hpp>
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    namespace detail
+    {
+
+      /** Rebuild a graph with vertices relabeled according to a given
+        * mapping.
+        *
+        * Vertex \c v of the original graph becomes vertex \c new_id[v] of the
+        * rebuilt graph. Vertices mapped to an id that is not less than \c
+        * num_new_vertices are removed along with their incident edges. The
+        * mapping should be injective on the vertices that are kept.
+        *
+        * This is the common backend of reorderVertices() and compactGraph(). */
+      template <typename Graph> void
+      relabelVertices (Graph& graph,
+                       const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& new_id,
+                       size_t num_new_vertices);
+
+    }
+
+    /** Compute a locality-improving vertex order by sorting the vertices of a
+      * graph along the Morton (Z-order) curve of their 3D coordinates.
+      *
+      * Vertices that are close in space end up close in the order, which
+      * improves cache behavior of the algorithms that iterate over edges.
+      * Vertices with non-finite coordinates are moved to the end.
+      *
+      * \c Graph has to be a model of concepts::PointCloudGraphConcept.
+      *
+      * \param[in]  graph an input graph
+      * \param[out] order a vector where i-th element is the (old) id of the
+      *             vertex that should become i-th vertex
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename Graph> void
+    computeMortonOrder (const Graph& graph,
+                        std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& order);
+
+
+    /** Compute a bandwidth-reducing vertex order of a graph using the reverse
+      * Cuthill-McKee algorithm.
+      *
+      * Unlike computeMortonOrder(), this takes the graph topology rather than
+      * the vertex coordinates into account. The resulting order keeps the
+      * non-zeros of the graph Laplacian close to the diagonal.
+      *
+      * \param[in]  graph an input graph
+      * \param[out] order a vector where i-th element is the (old) id of the
+      *             vertex that should become i-th vertex
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename Graph> void
+    computeReverseCuthillMcKeeOrder (const Graph& graph,
+                                     std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& order);
+
+
+    /** Permute the vertices of a graph according to a given order.
+      *
+      * The points bundled in vertices, internal vertex properties, and edges
+      * along with their internal properties are moved consistently. The edges
+      * are re-inserted sorted by their new end points, so that the edge list
+      * follows the new vertex order as well.
+      *
+      * In case of subgraphs, the graph should be a root without children (the
+      * children would be invalidated anyway).
+      *
+      * \c Graph has to be a model of concepts::PointCloudGraphConcept.
+      *
+      * \param[in,out] graph a graph to reorder
+      * \param[in]     order a vector where i-th element is the (old) id of the
+      *                vertex that should become i-th vertex, e.g. as computed
+      *                by computeMortonOrder()
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename Graph> void
+    reorderVertices (Graph& graph,
+                     const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& order);
+
+
+    /** Permute the vertices of a graph according to a given order and update
+      * a point to vertex map (as produced by GraphBuilder) accordingly.
+      *
+      * This is an overloaded function provided for convenience. See the
+      * documentation for reorderVertices().
+      *
+      * \param[in,out] graph a graph to reorder
+      * \param[in]     order a vector where i-th element is the (old) id of the
+      *                vertex that should become i-th vertex
+      * \param[in,out] point_to_vertex_map a mapping between points and graph
+      *                vertices, "nil" entries are left untouched
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename Graph> void
+    reorderVertices (Graph& graph,
+                     const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& order,
+                     std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& point_to_vertex_map);
+
+  }
+
+}
+
+#include "graph/impl/reorder.hpp"
+
+#endif /* PCL_GRAPH_REORDER_H */
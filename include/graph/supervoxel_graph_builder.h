@@ -0,0 +1,253 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_SUPERVOXEL_GRAPH_BUILDER_H
+#define PCL_GRAPH_SUPERVOXEL_GRAPH_BUILDER_H
+
+#include "graph/graph_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** This class builds a BGL graph representing an input dataset by
+      * clustering voxels into supervoxels.
+      *
+      * The points are voxelized with a given resolution (in the same way as
+      * in VoxelGridGraphBuilder, but without transform), and the voxels are
+      * clustered into supervoxels following the idea of VCCS ("Voxel Cloud
+      * Connectivity Segmentation" by J. Papon et al.):
+      *
+      * 1. Seeds are placed on a grid with a given (coarser) seed resolution;
+      *    in each occupied seed cell the voxel closest to the average of the
+      *    voxels in the cell becomes a seed.
+      * 2. Supervoxels are grown from the seeds through the 26-neighborhood
+      *    of voxels. The growing proceeds in parallel rounds: in each round
+      *    every unlabeled voxel adjacent to the labeled ones joins the
+      *    adjacent supervoxel it is closest to in terms of the combined
+      *    color, spatial, and normal distance (weighted by importances).
+      *    Voxels that are not reachable from any seed become seeds
+      *    themselves.
+      * 3. The supervoxel centers are updated and the seeds are moved to the
+      *    voxels closest to the centers. Growing and updating is repeated a
+      *    given number of times.
+      *
+      * Each supervoxel becomes a vertex positioned at the centroid of its
+      * points. Two supervoxels are connected with an edge if any of their
+      * voxels are adjacent.
+      *
+      * Color and normal distances are only used if the input point type has
+      * the corresponding fields.
+      *
+      * For additional information see documentation for \ref GraphBuilder.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT, typename GraphT>
+    class PCL_EXPORTS SupervoxelGraphBuilder : public GraphBuilder<PointT, GraphT>
+    {
+
+        using GraphBuilder<PointT, GraphT>::initCompute;
+        using PCLBase<PointT>::deinitCompute;
+        using PCLBase<PointT>::indices_;
+        using PCLBase<PointT>::input_;
+        using GraphBuilder<PointT, GraphT>::point_to_vertex_map_;
+
+      public:
+
+        using typename GraphBuilder<PointT, GraphT>::PointInT;
+        using typename GraphBuilder<PointT, GraphT>::PointOutT;
+        using typename GraphBuilder<PointT, GraphT>::VertexId;
+
+        /** Constructor.
+          *
+          * \param[in] voxel_resolution resolution of the voxel grid
+          * \param[in] seed_resolution distance between supervoxel seeds */
+        SupervoxelGraphBuilder (float voxel_resolution, float seed_resolution)
+        : voxel_resolution_ (voxel_resolution)
+        , seed_resolution_ (seed_resolution)
+        , color_importance_ (0.2f)
+        , spatial_importance_ (0.4f)
+        , normal_importance_ (1.0f)
+        , num_iterations_ (3)
+        {
+        }
+
+        virtual void
+        compute (GraphT& graph);
+
+        inline void
+        setVoxelResolution (float resolution)
+        {
+          voxel_resolution_ = resolution;
+        }
+
+        inline float
+        getVoxelResolution () const
+        {
+          return (voxel_resolution_);
+        }
+
+        inline void
+        setSeedResolution (float resolution)
+        {
+          seed_resolution_ = resolution;
+        }
+
+        inline float
+        getSeedResolution () const
+        {
+          return (seed_resolution_);
+        }
+
+        /** Set the weight of the color distance (RGB distance divided by
+          * 255). */
+        inline void
+        setColorImportance (float importance)
+        {
+          color_importance_ = importance;
+        }
+
+        inline float
+        getColorImportance () const
+        {
+          return (color_importance_);
+        }
+
+        /** Set the weight of the spatial distance (Euclidean distance divided
+          * by the seed resolution). */
+        inline void
+        setSpatialImportance (float importance)
+        {
+          spatial_importance_ = importance;
+        }
+
+        inline float
+        getSpatialImportance () const
+        {
+          return (spatial_importance_);
+        }
+
+        /** Set the weight of the normal distance (one minus absolute cosine of
+          * the angle between normals). */
+        inline void
+        setNormalImportance (float importance)
+        {
+          normal_importance_ = importance;
+        }
+
+        inline float
+        getNormalImportance () const
+        {
+          return (normal_importance_);
+        }
+
+        /** Set the number of times supervoxels are grown and their centers
+          * are updated. */
+        inline void
+        setNumberOfIterations (size_t num_iterations)
+        {
+          num_iterations_ = num_iterations;
+        }
+
+        inline size_t
+        getNumberOfIterations () const
+        {
+          return (num_iterations_);
+        }
+
+      private:
+
+        /// Average position, color, and normal of the points in a voxel (or
+        /// of the voxels in a supervoxel).
+        struct Features
+        {
+          Eigen::Vector3f xyz;
+          Eigen::Vector3f rgb;
+          Eigen::Vector3f normal;
+        };
+
+        /** Combined distance between the features of a voxel and a
+          * supervoxel. */
+        inline float
+        distance (const Features& f1, const Features& f2) const
+        {
+          return (color_importance_ * (f1.rgb - f2.rgb).norm () / 255.0f +
+                  spatial_importance_ * (f1.xyz - f2.xyz).norm () / seed_resolution_ +
+                  normal_importance_ * (1.0f - std::abs (f1.normal.dot (f2.normal))));
+        }
+
+        /** Grow supervoxels from the labeled voxels until no more unlabeled
+          * voxels can be reached.
+          *
+          * \param[in] frontier voxels to grow from
+          * \param[in] offsets, neighbors voxel adjacency in CSR format
+          * \param[in] voxels voxel features
+          * \param[in] supervoxels supervoxel features
+          * \param[in,out] labels supervoxel labels of voxels */
+        void
+        growSupervoxels (std::vector<size_t> frontier,
+                         const std::vector<size_t>& offsets,
+                         const std::vector<size_t>& neighbors,
+                         const std::vector<Features>& voxels,
+                         const std::vector<Features>& supervoxels,
+                         std::vector<size_t>& labels) const;
+
+        /// Resolution of the voxel grid.
+        float voxel_resolution_;
+
+        /// Distance between supervoxel seeds.
+        float seed_resolution_;
+
+        float color_importance_;
+        float spatial_importance_;
+        float normal_importance_;
+
+        size_t num_iterations_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/supervoxel_graph_builder.hpp"
+
+#endif /* PCL_GRAPH_SUPERVOXEL_GRAPH_BUILDER_H */
+
@@ -0,0 +1,276 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_TILED_VOXEL_GRID_GRAPH_BUILDER_H
+#define PCL_GRAPH_TILED_VOXEL_GRID_GRAPH_BUILDER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <boost/function.hpp>
+
+#include <pcl/point_cloud.h>
+
+#include "graph/point_cloud_graph.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** This class builds a voxel grid graph for datasets that do not fit in
+      * memory, and writes it to disk.
+      *
+      * The input points are pulled in chunks from a user-provided source
+      * (e.g. one scan of a merged dataset at a time). They are transformed
+      * and assigned to the voxels of a grid anchored at a fixed origin, as in
+      * IncrementalVoxelGridGraphBuilder. The grid is partitioned into cubic
+      * tiles of a given number of voxels, and the points are spilled into
+      * temporary per-tile files. The tiles are aligned with the voxels, so
+      * every voxel lies entirely in one tile.
+      *
+      * Then the tiles are processed one at a time. Each occupied voxel
+      * becomes a vertex positioned at the centroid of its points. Adjacent
+      * voxels of the same tile are connected right away. The voxels on the
+      * faces of a tile (which may have neighbors in other tiles) are kept in
+      * memory with their global keys, and the edges to the adjacent tiles
+      * that were processed before are stitched right away. The faces of a
+      * tile are released as soon as all of its neighbors are processed.
+      *
+      * The tiles are processed row by row and layer by layer (along the z
+      * axis), so peak memory is bounded by the size of a tile plus the
+      * faces of about one layer of tiles. It does not grow with the extent
+      * of the scene along the z axis, but it does grow with its cross-section
+      * in the x-y plane, so it is not bounded by the tile size alone.
+      *
+      * The vertices and edges are streamed to disk and assembled into a file
+      * in the format of saveGraph(), which may later be loaded with
+      * loadGraph(). Edge weights are written as zeros.
+      *
+      * Example usage:
+      *
+      * ~~~{.cpp}
+      * size_t next = 0;
+      * auto source = [&] (pcl::PointCloud<PointT>& chunk)
+      * {
+      *   return (next < files.size () && pcl::io::loadPCDFile (files[next++], chunk) == 0);
+      * };
+      * TiledVoxelGridGraphBuilder<PointT, Graph> builder (0.006f);
+      * builder.compute (source, "graph.pcd");
+      * ~~~
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT, typename GraphT>
+    class TiledVoxelGridGraphBuilder
+    {
+
+      public:
+
+        /// Type of points in the output graph.
+        typedef typename point_cloud_graph_traits<GraphT>::point_type PointOutT;
+
+        /** A source of input points. Each call should fill the cloud with
+          * the next chunk of points and return \c true, or return \c false
+          * when there are no more points. */
+        typedef boost::function<bool (pcl::PointCloud<PointT>&)> PointSource;
+
+        /** Constructor.
+          *
+          * \param[in] voxel_resolution resolution of the voxel grid
+          * \param[in] tile_size number of voxels along each side of a tile */
+        TiledVoxelGridGraphBuilder (float voxel_resolution, unsigned int tile_size = 128)
+        : voxel_resolution_ (voxel_resolution)
+        , tile_size_ (tile_size > 0 ? tile_size : 1)
+        , use_transform_ (true)
+        , max_buffered_points_ (1 << 20)
+        , num_vertices_ (0)
+        , num_edges_ (0)
+        , num_tiles_ (0)
+        {
+        }
+
+        /** Build a graph from the points pulled from a given source and write
+          * it to a file.
+          *
+          * \return \c false if an I/O error occurred */
+        bool
+        compute (const PointSource& source, const std::string& filename);
+
+        inline void
+        setVoxelResolution (float resolution)
+        {
+          voxel_resolution_ = resolution;
+        }
+
+        inline float
+        getVoxelResolution () const
+        {
+          return (voxel_resolution_);
+        }
+
+        /** Set the number of voxels along each side of a tile. */
+        inline void
+        setTileSize (unsigned int tile_size)
+        {
+          tile_size_ = tile_size > 0 ? tile_size : 1;
+        }
+
+        inline unsigned int
+        getTileSize () const
+        {
+          return (tile_size_);
+        }
+
+        /** Set whether the points should be transformed to (x/z, y/z, log z)
+          * space before voxelization. */
+        inline void
+        setUseTransform (bool use_transform)
+        {
+          use_transform_ = use_transform;
+        }
+
+        inline bool
+        getUseTransform () const
+        {
+          return (use_transform_);
+        }
+
+        /** Set the number of points that may be kept in memory before they
+          * are spilled into per-tile files. */
+        inline void
+        setMaxBufferedPoints (size_t max_buffered_points)
+        {
+          max_buffered_points_ = max_buffered_points;
+        }
+
+        inline size_t
+        getMaxBufferedPoints () const
+        {
+          return (max_buffered_points_);
+        }
+
+        /** Set the directory for temporary files. By default the system
+          * temporary directory is used. */
+        inline void
+        setTemporaryDirectory (const std::string& directory)
+        {
+          temporary_directory_ = directory;
+        }
+
+        inline size_t
+        getNumberOfVertices () const
+        {
+          return (num_vertices_);
+        }
+
+        inline size_t
+        getNumberOfEdges () const
+        {
+          return (num_edges_);
+        }
+
+        inline size_t
+        getNumberOfTiles () const
+        {
+          return (num_tiles_);
+        }
+
+      private:
+
+        /// A point along with the key of its voxel.
+        struct KeyedPoint
+        {
+          uint64_t key;
+          PointT point;
+        };
+
+        typedef std::vector<KeyedPoint, Eigen::aligned_allocator<KeyedPoint> > TileBuffer;
+
+        /// Voxels on the faces of a tile, (global voxel key, vertex id) pairs.
+        typedef std::vector<std::pair<uint64_t, uint64_t> > Boundary;
+
+        /** Append the buffered points to the per-tile files and clear the
+          * buffers. */
+        bool
+        flushTiles (const std::string& directory, std::map<uint64_t, TileBuffer>& buffers) const;
+
+        /** Build the vertices and the internal edges of a tile and collect
+          * the voxels on its boundary. */
+        bool
+        processTile (uint64_t tile,
+                     const std::string& path,
+                     std::ofstream& vertices,
+                     std::ofstream& edges,
+                     Boundary& boundary);
+
+        /** Write the edges between the boundary voxels of a tile and the
+          * boundary voxels of the adjacent tiles that were processed before
+          * it (\a pending, indexed by tile key). */
+        bool
+        stitchTile (uint64_t tile,
+                    const Boundary& boundary,
+                    const std::map<uint64_t, Boundary>& pending,
+                    std::ofstream& edges);
+
+        /** Get the key of the tile that contains a given voxel. */
+        inline uint64_t
+        getTileKey (uint64_t voxel_key) const;
+
+        float voxel_resolution_;
+        unsigned int tile_size_;
+        bool use_transform_;
+        size_t max_buffered_points_;
+        std::string temporary_directory_;
+
+        size_t num_vertices_;
+        size_t num_edges_;
+        size_t num_tiles_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/tiled_voxel_grid_graph_builder.hpp"
+
+#endif /* PCL_GRAPH_TILED_VOXEL_GRID_GRAPH_BUILDER_H */
+
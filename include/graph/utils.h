@@ -38,7 +38,14 @@
 #ifndef PCL_GRAPH_UTILS_H
 #define PCL_GRAPH_UTILS_H
 
+#include <algorithm>
+
 #include <boost/mpl/has_xxx.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace pcl
 {
@@ -52,6 +59,35 @@ namespace pcl
       // typedef. This will be used to distinguish between boost::subgraph (does
       // have), and normal graph types (do not have).
       BOOST_MPL_HAS_XXX_TRAIT_NAMED_DEF(has_root_graph, graph_type, false)
+
+      /** Get the number of threads that an OpenMP parallel region would use
+        * (1 if compiled without OpenMP support). */
+      inline int
+      getMaxNumberOfThreads ()
+      {
+#ifdef _OPENMP
+        return (omp_get_max_threads ());
+#else
+        return (1);
+#endif
+      }
+
+      /** Get the range of elements [begin, end) that belongs to a given chunk
+        * when \a size elements are split into \a num_chunks contiguous chunks
+        * of (almost) equal size.
+        *
+        * Parallel loops in this module iterate over chunks rather than over
+        * elements when the order in which the results are produced matters:
+        * processing chunks independently and concatenating their results in
+        * chunk order gives the same output as a serial loop. */
+      inline std::pair<size_t, size_t>
+      getChunkRange (size_t chunk, size_t num_chunks, size_t size)
+      {
+        const size_t chunk_size = (size + num_chunks - 1) / num_chunks;
+        const size_t begin = std::min (size, chunk * chunk_size);
+        const size_t end = std::min (size, begin + chunk_size);
+        return (std::make_pair (begin, end));
+      }
     }
 
     /** remove_edge_if structure is an "extended" version of,
@@ -81,6 +117,35 @@ namespace pcl
       }
     };
 
+    /** underlying_graph structure provides access to the graph object that
+      * actually stores vertex and edge data.
+      *
+      * For plain graphs this is the graph itself, whereas for subgraphs this
+      * is member field `m_graph` of the root subgraph. */
+    template <typename Graph, typename Enable = void>
+    struct underlying_graph
+    {
+      typedef Graph type;
+
+      type&
+      operator () (Graph& graph) const
+      {
+        return (graph);
+      }
+    };
+
+    template <typename Graph>
+    struct underlying_graph<Graph, typename boost::enable_if<detail::has_root_graph<Graph> >::type>
+    {
+      typedef typename Graph::graph_type type;
+
+      type&
+      operator () (Graph& graph) const
+      {
+        return (graph.root ().m_graph);
+      }
+    };
+
   }
 
 }
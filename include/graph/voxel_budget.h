@@ -0,0 +1,135 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_VOXEL_BUDGET_H
+#define PCL_GRAPH_VOXEL_BUDGET_H
+
+#include <vector>
+#include <limits>
+
+#include <Eigen/Core>
+
+#include <pcl/point_cloud.h>
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** Count the voxels occupied by (a subset of) the points of a cloud.
+      *
+      * The grid has cubic voxels of a given size, its corner is at a given
+      * origin. Non-finite points are ignored. The counting stops as soon as
+      * more than \a limit occupied voxels are found, so this is cheap for
+      * grids that are too fine for a vertex budget.
+      *
+      * \param[in] cloud input cloud
+      * \param[in] indices indices of the points to consider
+      * \param[in] origin corner of the grid
+      * \param[in] resolution voxel size
+      * \param[in] limit stop counting after this number of voxels
+      *
+      * \return the number of occupied voxels (at most \a limit + 1), or
+      * std::numeric_limits<size_t>::max () if some point falls outside of
+      * the key range supported by packVoxelKey()
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT> size_t
+    countOccupiedVoxels (const pcl::PointCloud<PointT>& cloud,
+                         const std::vector<int>& indices,
+                         const Eigen::Vector3d& origin,
+                         double resolution,
+                         size_t limit = std::numeric_limits<size_t>::max () - 1);
+
+    /** Find the finest voxel resolution (not finer than a given one) at
+      * which the number of occupied voxels does not exceed a budget.
+      *
+      * The search first doubles the resolution until the budget is met and
+      * then bisects (in log space) between the last two candidates, until
+      * they are within the given relative precision. The returned resolution
+      * was verified to satisfy the budget.
+      *
+      * \param[in] min_resolution the finest acceptable resolution
+      * \param[in] max_voxels the budget (should be positive)
+      * \param[in] count_voxels a function object that takes a resolution and
+      *            a limit and returns the number of occupied voxels (see
+      *            countOccupiedVoxels())
+      * \param[in] precision relative precision of the returned resolution
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename CountFunction> float
+    computeBudgetedVoxelResolution (float min_resolution,
+                                    size_t max_voxels,
+                                    CountFunction count_voxels,
+                                    float precision = 0.01f);
+
+    /** Select one point per occupied voxel.
+      *
+      * The point closest to the center of its voxel is selected. The voxels
+      * are numbered in the order in which they are first encountered in
+      * \a indices.
+      *
+      * \param[in] cloud input cloud
+      * \param[in] indices indices of the (finite) points to consider
+      * \param[in] origin corner of the grid
+      * \param[in] resolution voxel size
+      * \param[out] representatives indices of the selected points, one per
+      *             voxel
+      * \param[out] voxels for each element of \a indices, the number of its
+      *             voxel (i.e. the position of its representative)
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT> void
+    selectVoxelRepresentatives (const pcl::PointCloud<PointT>& cloud,
+                                const std::vector<int>& indices,
+                                const Eigen::Vector3d& origin,
+                                double resolution,
+                                std::vector<int>& representatives,
+                                std::vector<size_t>& voxels);
+
+  }
+
+}
+
+#include "graph/impl/voxel_budget.hpp"
+
+#endif /* PCL_GRAPH_VOXEL_BUDGET_H */
+
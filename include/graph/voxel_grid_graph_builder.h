@@ -49,6 +49,19 @@ namespace pcl
     /** This class builds a BGL graph representing an input dataset by using
       * octree::OctreePointCloud.
       *
+      * The points are transformed to (x/z, y/z, log z) space (unless this is
+      * disabled with setUseTransform()) and partitioned into voxels. The
+      * transform makes the voxel size grow with the distance from the sensor,
+      * which matches the resolution of the data produced by depth cameras.
+      * Each occupied voxel becomes a vertex (positioned at the centroid of
+      * the voxel points), and vertices that correspond to adjacent voxels
+      * (26-neighborhood) are connected with edges.
+      *
+      * Two voxelization methods are available (see setVoxelizationMethod()).
+      * They produce identical graphs, but the sort-based method (default)
+      * does not build a pointer-based tree and runs in parallel if OpenMP is
+      * enabled.
+      *
       * For additional information see documentation for \ref GraphBuilder.
       *
       * \author Sergey Alexandrov
@@ -57,7 +70,7 @@ namespace pcl
     class PCL_EXPORTS VoxelGridGraphBuilder : public GraphBuilder<PointT, GraphT>
     {
 
-        using PCLBase<PointT>::initCompute;
+        using GraphBuilder<PointT, GraphT>::initCompute;
         using PCLBase<PointT>::deinitCompute;
         using PCLBase<PointT>::indices_;
         using PCLBase<PointT>::input_;
@@ -69,11 +82,26 @@ namespace pcl
         using typename GraphBuilder<PointT, GraphT>::PointOutT;
         using typename GraphBuilder<PointT, GraphT>::VertexId;
 
+        /** Different methods to partition the points into voxels. */
+        enum VoxelizationMethod
+        {
+          /// Insert points in octree::OctreePointCloud and iterate over its
+          /// leaves.
+          VOXELIZATION_OCTREE,
+          /// Compute voxel keys, sort (key, point index) pairs along the
+          /// Morton curve with radix sort, and reduce runs of equal keys.
+          VOXELIZATION_SORT
+        };
+
         /** Constructor.
           *
           * \param[in] voxel_resolution resolution of the voxel grid */
         VoxelGridGraphBuilder (float voxel_resolution)
         : voxel_resolution_ (voxel_resolution)
+        , effective_resolution_ (voxel_resolution)
+        , max_num_vertices_ (0)
+        , voxelization_method_ (VOXELIZATION_SORT)
+        , use_transform_ (true)
         {
         }
 
@@ -92,11 +120,101 @@ namespace pcl
           return (voxel_resolution_);
         }
 
+        /** Set the maximum number of vertices in the output graph (0 means
+          * no limit).
+          *
+          * If the voxel grid with the requested resolution would have more
+          * occupied voxels than that, the resolution is increased (by the
+          * smallest amount found with computeBudgetedVoxelResolution()) to
+          * meet the budget. */
+        inline void
+        setMaxNumberOfVertices (size_t max_num_vertices)
+        {
+          max_num_vertices_ = max_num_vertices;
+        }
+
+        inline size_t
+        getMaxNumberOfVertices () const
+        {
+          return (max_num_vertices_);
+        }
+
+        /** Get the voxel resolution that was used in the last compute()
+          * call. It differs from getVoxelResolution() if the resolution had
+          * to be increased to meet the vertex budget. */
+        inline float
+        getEffectiveVoxelResolution () const
+        {
+          return (effective_resolution_);
+        }
+
+        inline void
+        setVoxelizationMethod (VoxelizationMethod method)
+        {
+          voxelization_method_ = method;
+        }
+
+        inline VoxelizationMethod
+        getVoxelizationMethod () const
+        {
+          return (voxelization_method_);
+        }
+
+        /** Set whether the points should be transformed to (x/z, y/z, log z)
+          * space before voxelization. */
+        inline void
+        setUseTransform (bool use_transform)
+        {
+          use_transform_ = use_transform;
+        }
+
+        inline bool
+        getUseTransform () const
+        {
+          return (use_transform_);
+        }
+
       private:
 
+        typedef pcl::PointCloud<pcl::PointXYZ> TransformedCloud;
+        typedef TransformedCloud::Ptr TransformedCloudPtr;
+
+        /** Voxelize the transformed cloud using octree::OctreePointCloud and
+          * build the graph. */
+        void
+        computeOctreeBased (const TransformedCloudPtr& transformed,
+                            const Eigen::Vector4f& min,
+                            const Eigen::Vector4f& max,
+                            GraphT& graph);
+
+        /** Voxelize the transformed cloud by sorting the points by their
+          * voxel keys and build the graph.
+          *
+          * The voxel keys and the order of the vertices are the same as in
+          * computeOctreeBased(). Returns \c false (without modifying the
+          * graph) if this can not be guaranteed, i.e. if the octree would
+          * have to be deeper than 21 levels or expanded after construction. */
+        bool
+        computeSortBased (const TransformedCloudPtr& transformed,
+                          const Eigen::Vector4f& min,
+                          const Eigen::Vector4f& max,
+                          GraphT& graph);
+
         /// Resolution of the voxel grid.
         float voxel_resolution_;
 
+        /// Resolution of the voxel grid used in the last compute() call.
+        float effective_resolution_;
+
+        /// Maximum number of vertices in the output graph (0 = no limit).
+        size_t max_num_vertices_;
+
+        /// Method used to partition the points into voxels.
+        VoxelizationMethod voxelization_method_;
+
+        /// Whether the points are transformed before voxelization.
+        bool use_transform_;
+
     };
 
   }
@@ -0,0 +1,218 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_VOXEL_GRID_GRAPH_PYRAMID_BUILDER_H
+#define PCL_GRAPH_VOXEL_GRID_GRAPH_PYRAMID_BUILDER_H
+
+#include <boost/shared_ptr.hpp>
+
+#include "graph/graph_builder.h"
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** This class builds a pyramid of voxel grid graphs with resolutions
+      * that differ by a factor of two between adjacent levels, in a single
+      * pass over the input dataset.
+      *
+      * Level \c 0 is the same graph as the one VoxelGridGraphBuilder produces
+      * with the given voxel resolution. Each subsequent level corresponds to
+      * the next shallower depth of the octree: its voxels are twice as large
+      * and contain the points of up to eight voxels of the previous level.
+      * The points are transformed, voxelized, and sorted along the Morton
+      * curve only once; since the voxels of each level are contiguous runs of
+      * this order, coarser levels are obtained by merging runs. Likewise,
+      * the vertices of coarser levels are computed by merging the centroid
+      * sums of their children, so the points are only visited once. Vertices
+      * of all levels are numbered in Morton order.
+      *
+      * The builder keeps the mappings between adjacent levels. The children
+      * of a vertex are a contiguous range of vertices of the previous level
+      * (see getChildrenOffsets()), and every vertex has one parent in the
+      * next level (see getFineToCoarseMap()).
+      *
+      * The GraphBuilder::compute() interface builds only level \c 0.
+      *
+      * Example usage:
+      *
+      * ~~~{.cpp}
+      * VoxelGridGraphPyramidBuilder<PointT, Graph> builder (0.006f, 4);
+      * builder.setInputCloud (cloud);
+      * std::vector<VoxelGridGraphPyramidBuilder<PointT, Graph>::GraphPtr> levels;
+      * builder.compute (levels);
+      * // Parent of vertex v of the finest level
+      * size_t parent = builder.getFineToCoarseMap (0)[v];
+      * ~~~
+      *
+      * \note The vertex ordering (see setVertexOrdering()) is only applied
+      * when a single graph is built, because reordering the vertices of the
+      * levels would break the contiguity of children ranges.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    template <typename PointT, typename GraphT>
+    class PCL_EXPORTS VoxelGridGraphPyramidBuilder : public GraphBuilder<PointT, GraphT>
+    {
+
+        using GraphBuilder<PointT, GraphT>::initCompute;
+        using PCLBase<PointT>::deinitCompute;
+        using PCLBase<PointT>::indices_;
+        using PCLBase<PointT>::input_;
+        using GraphBuilder<PointT, GraphT>::point_to_vertex_map_;
+
+      public:
+
+        using typename GraphBuilder<PointT, GraphT>::PointInT;
+        using typename GraphBuilder<PointT, GraphT>::PointOutT;
+        using typename GraphBuilder<PointT, GraphT>::VertexId;
+
+        typedef boost::shared_ptr<GraphT> GraphPtr;
+
+        /** Constructor.
+          *
+          * \param[in] voxel_resolution resolution of the voxel grid at the
+          * finest level
+          * \param[in] num_levels number of levels in the pyramid */
+        VoxelGridGraphPyramidBuilder (float voxel_resolution, size_t num_levels = 4)
+        : voxel_resolution_ (voxel_resolution)
+        , num_levels_ (num_levels)
+        , use_transform_ (true)
+        {
+        }
+
+        /** Build the finest level only. */
+        virtual void
+        compute (GraphT& graph);
+
+        /** Build the pyramid.
+          *
+          * The number of levels may be smaller than requested if the octree
+          * is not deep enough. In case of failure (octree deeper than 21
+          * levels) no levels are output.
+          *
+          * \param[out] levels graphs of the levels, finest first */
+        void
+        compute (std::vector<GraphPtr>& levels);
+
+        /** Get the mapping between the vertices of a given level and their
+          * parents in the next (coarser) level. */
+        inline const std::vector<VertexId>&
+        getFineToCoarseMap (size_t level) const
+        {
+          return (fine_to_coarse_.at (level));
+        }
+
+        /** Get the children ranges of the vertices of a given level (> 0).
+          *
+          * The children of vertex \c v are the vertices \c offsets[v] ...
+          * \c offsets[v + 1] - 1 of level \a level - 1. */
+        inline const std::vector<size_t>&
+        getChildrenOffsets (size_t level) const
+        {
+          return (children_offsets_.at (level - 1));
+        }
+
+        inline void
+        setVoxelResolution (float resolution)
+        {
+          voxel_resolution_ = resolution;
+        }
+
+        inline float
+        getVoxelResolution () const
+        {
+          return (voxel_resolution_);
+        }
+
+        inline void
+        setNumberOfLevels (size_t num_levels)
+        {
+          num_levels_ = num_levels;
+        }
+
+        inline size_t
+        getNumberOfLevels () const
+        {
+          return (num_levels_);
+        }
+
+        /** Set whether the points should be transformed to (x/z, y/z, log z)
+          * space before voxelization. */
+        inline void
+        setUseTransform (bool use_transform)
+        {
+          use_transform_ = use_transform;
+        }
+
+        inline bool
+        getUseTransform () const
+        {
+          return (use_transform_);
+        }
+
+      private:
+
+        /** Build up to \a num_levels levels, the first one is output in
+          * \a finest, the rest are appended to \a coarser. */
+        bool
+        computeLevels (size_t num_levels, GraphT& finest, std::vector<GraphPtr>& coarser);
+
+        /// Resolution of the voxel grid at the finest level.
+        float voxel_resolution_;
+
+        /// Requested number of levels.
+        size_t num_levels_;
+
+        /// Whether the points are transformed before voxelization.
+        bool use_transform_;
+
+        std::vector<std::vector<VertexId> > fine_to_coarse_;
+        std::vector<std::vector<size_t> > children_offsets_;
+
+    };
+
+  }
+
+}
+
+#include "graph/impl/voxel_grid_graph_pyramid_builder.hpp"
+
+#endif /* PCL_GRAPH_VOXEL_GRID_GRAPH_PYRAMID_BUILDER_H */
+
@@ -0,0 +1,215 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_GRAPH_VOXEL_HASH_H
+#define PCL_GRAPH_VOXEL_HASH_H
+
+#include <cmath>
+#include <vector>
+#include <limits>
+
+#include <boost/cstdint.hpp>
+
+namespace pcl
+{
+
+  namespace graph
+  {
+
+    /** Pack integer voxel coordinates into a single 64-bit key.
+      *
+      * Each coordinate takes 21 bits, thus the coordinates should be less
+      * than 2^21. */
+    inline uint64_t
+    packVoxelKey (uint32_t x, uint32_t y, uint32_t z)
+    {
+      return (static_cast<uint64_t> (x) | static_cast<uint64_t> (y) << 21 | static_cast<uint64_t> (z) << 42);
+    }
+
+    /** Unpack integer voxel coordinates from a key produced with
+      * packVoxelKey(). */
+    inline void
+    unpackVoxelKey (uint64_t key, uint32_t& x, uint32_t& y, uint32_t& z)
+    {
+      x = static_cast<uint32_t> (key & 0x1fffff);
+      y = static_cast<uint32_t> ((key >> 21) & 0x1fffff);
+      z = static_cast<uint32_t> ((key >> 42) & 0x1fffff);
+    }
+
+    /** The maximum number of voxels along each axis supported by
+      * packVoxelKey(). */
+    const uint32_t MAX_VOXEL_KEY = 1u << 21;
+
+    /** Compute the packed key of the voxel that contains a given point in
+      * a grid with a given resolution anchored at the origin.
+      *
+      * Unlike the keys of an octree, these keys do not depend on the extent
+      * of the data, so they stay the same between different clouds. The
+      * origin is mapped to the middle of the key range, thus coordinates
+      * within +/- 2^20 voxels are supported.
+      *
+      * \return \c false if the point is outside of the supported range (or
+      * is not finite) */
+    inline bool
+    computeAnchoredVoxelKey (float x, float y, float z, float resolution, uint64_t& key)
+    {
+      const float c[3] = { x, y, z };
+      int64_t k[3];
+      for (size_t i = 0; i < 3; ++i)
+      {
+        const float f = std::floor (c[i] / resolution);
+        // Also rejects NaNs
+        if (!(f >= -static_cast<float> (MAX_VOXEL_KEY / 2) && f < static_cast<float> (MAX_VOXEL_KEY / 2)))
+          return (false);
+        k[i] = static_cast<int64_t> (f) + MAX_VOXEL_KEY / 2;
+      }
+      key = packVoxelKey (k[0], k[1], k[2]);
+      return (true);
+    }
+
+    /** Offsets of the "forward" half of the 26-neighborhood of a voxel.
+      *
+      * These are the 13 offsets that are lexicographically greater than
+      * (0, 0, 0). Every pair of adjacent voxels is related by exactly one of
+      * these offsets (in one direction or the other), so visiting them for
+      * each voxel finds every undirected adjacency exactly once. */
+    const int HALF_STENCIL[13][3] =
+    {
+      { 0,  0,  1},
+      { 0,  1, -1}, { 0,  1,  0}, { 0,  1,  1},
+      { 1, -1, -1}, { 1, -1,  0}, { 1, -1,  1},
+      { 1,  0, -1}, { 1,  0,  0}, { 1,  0,  1},
+      { 1,  1, -1}, { 1,  1,  0}, { 1,  1,  1},
+    };
+
+    /** A hash table that maps packed voxel keys to (vertex) ids.
+      *
+      * The table uses open addressing with linear probing over a flat array
+      * of slots, which is much more cache-friendly than node-based hash maps.
+      * The table does not grow, the expected number of elements should be
+      * given at construction time. Elements can not be removed.
+      *
+      * Concurrent find() calls are safe as long as no insert() happens in the
+      * meantime.
+      *
+      * \author Sergey Alexandrov
+      * \ingroup graph */
+    class VoxelHashTable
+    {
+
+      public:
+
+        /** Construct a table with enough capacity for a given number of
+          * elements (at most half of the slots will be occupied). */
+        VoxelHashTable (size_t expected_size)
+        : size_ (0)
+        {
+          size_t capacity = 16;
+          while (capacity < 2 * expected_size)
+            capacity <<= 1;
+          mask_ = capacity - 1;
+          slots_.resize (capacity, Slot (std::numeric_limits<uint64_t>::max (), 0));
+        }
+
+        /** Insert a key-value pair, or overwrite the value if the key is
+          * already present. */
+        inline void
+        insert (uint64_t key, size_t value)
+        {
+          size_t i = hash (key) & mask_;
+          while (slots_[i].first != EMPTY && slots_[i].first != key)
+            i = (i + 1) & mask_;
+          if (slots_[i].first == EMPTY)
+            ++size_;
+          slots_[i] = Slot (key, value);
+        }
+
+        /** Find the value associated with a key.
+          *
+          * \return \c true if the key is present in the table */
+        inline bool
+        find (uint64_t key, size_t& value) const
+        {
+          size_t i = hash (key) & mask_;
+          while (slots_[i].first != EMPTY)
+          {
+            if (slots_[i].first == key)
+            {
+              value = slots_[i].second;
+              return (true);
+            }
+            i = (i + 1) & mask_;
+          }
+          return (false);
+        }
+
+        inline size_t
+        size () const
+        {
+          return (size_);
+        }
+
+      private:
+
+        typedef std::pair<uint64_t, size_t> Slot;
+
+        /// Marks empty slots, can not be produced by packVoxelKey().
+        static const uint64_t EMPTY = std::numeric_limits<uint64_t>::max ();
+
+        /** Mix the bits of a key (finalizer of MurmurHash3). */
+        static inline size_t
+        hash (uint64_t key)
+        {
+          key ^= key >> 33;
+          key *= 0xff51afd7ed558ccdull;
+          key ^= key >> 33;
+          key *= 0xc4ceb9fe1a85ec53ull;
+          key ^= key >> 33;
+          return (static_cast<size_t> (key));
+        }
+
+        std::vector<Slot> slots_;
+        size_t mask_;
+        size_t size_;
+
+    };
+
+  }
+
+}
+
+#endif /* PCL_GRAPH_VOXEL_HASH_H */
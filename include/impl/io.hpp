@@ -7,6 +7,7 @@
 #include <pcl/io/pcd_io.h>
 #include <pcl/console/print.h>
 
+#include "graph/arena_allocator.h"
 #include "graph/point_cloud_graph.h"
 #include "as_range.h"
 
@@ -100,5 +101,117 @@ loadGraph (const std::string& filename,
   return true;
 }
 
+/** Header of the files written by saveGraphBinary(). */
+struct BinaryGraphHeader
+{
+  char magic[8];
+  uint32_t point_size;
+  uint32_t reserved;
+  uint64_t num_vertices;
+  uint64_t num_edges;
+  uint64_t num_points;
+};
+
+const char BINARY_GRAPH_MAGIC[8] = { 'P', 'C', 'G', 'R', 'A', 'P', 'H', '1' };
+
+template <typename Graph> bool
+saveGraphBinary (const std::string& filename,
+                 const Graph& graph,
+                 const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& point_to_vertex_map)
+{
+  typedef typename pcl::graph::point_cloud_graph_traits<Graph>::point_type PointT;
+
+  BinaryGraphHeader header;
+  std::copy (BINARY_GRAPH_MAGIC, BINARY_GRAPH_MAGIC + 8, header.magic);
+  header.point_size = sizeof (PointT);
+  header.reserved = 0;
+  header.num_vertices = boost::num_vertices (graph);
+  header.num_edges = boost::num_edges (graph);
+  header.num_points = point_to_vertex_map.size ();
+
+  // Edges are stored as three separate arrays (sources, targets, weights),
+  // so that each of them is written and read with a single call.
+  std::vector<uint64_t> sources;
+  std::vector<uint64_t> targets;
+  std::vector<float> weights;
+  sources.reserve (header.num_edges);
+  targets.reserve (header.num_edges);
+  weights.reserve (header.num_edges);
+  auto weight_map = boost::get (boost::edge_weight, graph);
+  for (const auto& edge : as_range (boost::edges (graph)))
+  {
+    sources.push_back (boost::source (edge, graph));
+    targets.push_back (boost::target (edge, graph));
+    weights.push_back (weight_map[edge]);
+  }
+  std::vector<uint64_t> p2v (point_to_vertex_map.begin (), point_to_vertex_map.end ());
+
+  std::ofstream file (filename, std::ios::binary);
+  file.write (reinterpret_cast<const char*> (&header), sizeof (header));
+  const auto& cloud = *pcl::graph::point_cloud (graph);
+  if (header.num_vertices)
+    file.write (reinterpret_cast<const char*> (&cloud.points[0]), header.num_vertices * sizeof (PointT));
+  if (header.num_edges)
+  {
+    file.write (reinterpret_cast<const char*> (&sources[0]), header.num_edges * sizeof (uint64_t));
+    file.write (reinterpret_cast<const char*> (&targets[0]), header.num_edges * sizeof (uint64_t));
+    file.write (reinterpret_cast<const char*> (&weights[0]), header.num_edges * sizeof (float));
+  }
+  if (header.num_points)
+    file.write (reinterpret_cast<const char*> (&p2v[0]), header.num_points * sizeof (uint64_t));
+  return (file.good ());
+}
+
+template <typename Graph> bool
+loadGraphBinary (const std::string& filename,
+                 Graph& graph,
+                 std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& point_to_vertex_map)
+{
+  typedef typename pcl::graph::point_cloud_graph_traits<Graph>::point_type PointT;
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor VertexId;
+  typedef pcl::PointCloud<PointT> PointCloudT;
+
+  std::ifstream file (filename, std::ios::binary);
+  BinaryGraphHeader header;
+  if (!file.read (reinterpret_cast<char*> (&header), sizeof (header)) ||
+      !std::equal (BINARY_GRAPH_MAGIC, BINARY_GRAPH_MAGIC + 8, header.magic) ||
+      header.point_size != sizeof (PointT))
+    return (false);
+
+  typename PointCloudT::Ptr cloud (new PointCloudT);
+  cloud->resize (header.num_vertices);
+  std::vector<uint64_t> sources (header.num_edges);
+  std::vector<uint64_t> targets (header.num_edges);
+  std::vector<float> weights (header.num_edges);
+  std::vector<uint64_t> p2v (header.num_points);
+  if (header.num_vertices)
+    file.read (reinterpret_cast<char*> (&cloud->points[0]), header.num_vertices * sizeof (PointT));
+  if (header.num_edges)
+  {
+    file.read (reinterpret_cast<char*> (&sources[0]), header.num_edges * sizeof (uint64_t));
+    file.read (reinterpret_cast<char*> (&targets[0]), header.num_edges * sizeof (uint64_t));
+    file.read (reinterpret_cast<char*> (&weights[0]), header.num_edges * sizeof (float));
+  }
+  if (header.num_points)
+    file.read (reinterpret_cast<char*> (&p2v[0]), header.num_points * sizeof (uint64_t));
+  if (!file)
+    return (false);
+  for (size_t i = 0; i < header.num_edges; ++i)
+    if (sources[i] >= header.num_vertices || targets[i] >= header.num_vertices)
+      return (false);
+
+  pcl::graph::ScopedArena arena (pcl::graph::MonotonicArena::Ptr (new pcl::graph::MonotonicArena (pcl::graph::estimateArenaSize (header.num_edges))));
+  graph = Graph (cloud);
+  pcl::graph::bindEdgeListToCurrentArena (graph);
+  for (size_t i = 0; i < header.num_edges; ++i)
+  {
+    const VertexId s = sources[i];
+    const VertexId t = targets[i];
+    boost::add_edge (s, t, weights[i], graph);
+  }
+  point_to_vertex_map.assign (p2v.begin (), p2v.end ());
+  return (true);
+}
+
 #endif /* IO_HPP */
 
@@ -48,6 +48,8 @@ template<typename PointT, typename LeafContainerT, typename BranchContainerT>
 pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::OctreePointCloudAdjacency (const double resolution_arg) 
 : OctreePointCloud<PointT, LeafContainerT, BranchContainerT
 , OctreeBase<LeafContainerT, BranchContainerT> > (resolution_arg)
+, packed_keys_ (true)
+, leaf_index_ (0)
 {
 
 }
@@ -79,62 +81,29 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
       maxZ = temp.z;
   }
   this->defineBoundingBox (minX, minY, minZ, maxX, maxY, maxZ);
-  //t1 = timer_.getTime ();
   OctreePointCloud<PointT, LeafContainerT, BranchContainerT>::addPointsFromInputCloud ();
 
-
-  //t2 = timer_.getTime ();
-  //std::cout << "Add Points:"<<t2-t1<<" ms  Num leaves ="<<this->getLeafCount ()<<"\n";
-   
-  std::list <std::pair<OctreeKey,LeafContainerT*> > delete_list;
-  //double t_temp, t_neigh, t_compute, t_getLeaf;
-  //t_neigh = t_compute = t_getLeaf = 0;
-  LeafContainerT *leaf_container;
-  typename OctreeAdjacencyT::LeafNodeIterator leaf_itr;
+  leaf_vector_.clear ();
+  leaf_keys_.clear ();
   leaf_vector_.reserve (this->getLeafCount ());
-  for ( leaf_itr = this->leaf_begin () ; leaf_itr != this->leaf_end (); ++leaf_itr)
-  {
-    //t_temp = timer_.getTime ();
-    OctreeKey leaf_key = leaf_itr.getCurrentOctreeKey ();
-    leaf_container = &(leaf_itr.getLeafContainer ());
-    //t_getLeaf += timer_.getTime () - t_temp;
-    
-    //t_temp = timer_.getTime ();
-    //Run the leaf's compute function
-    leaf_container->computeData ();
-    //t_compute += timer_.getTime () - t_temp;
-     
-    //t_temp = timer_.getTime ();
-    //  std::cout << "Computing neighbors\n";
-    computeNeighbors (leaf_key, leaf_container);
-    //t_neigh += timer_.getTime () - t_temp;
-    
-    leaf_vector_.push_back (leaf_container);
-
-  }
-  //Go through and delete voxels scheduled
-  for (typename std::list<std::pair<OctreeKey,LeafContainerT*> >::iterator delete_itr = delete_list.begin (); delete_itr != delete_list.end (); ++delete_itr)
+  leaf_keys_.reserve (this->getLeafCount ());
+  for (typename OctreeAdjacencyT::LeafNodeIterator leaf_itr = this->leaf_begin (); leaf_itr != this->leaf_end (); ++leaf_itr)
   {
-    leaf_container = delete_itr->second;
-    //Remove pointer to it from all neighbors
-    typename std::set<LeafContainerT*>::iterator neighbor_itr = leaf_container->begin ();
-    typename std::set<LeafContainerT*>::iterator neighbor_end = leaf_container->end ();
-    for ( ; neighbor_itr != neighbor_end; ++neighbor_itr)
-    {
-      //Don't delete self neighbor
-      if (*neighbor_itr != leaf_container)
-        (*neighbor_itr)->removeNeighbor (leaf_container);
-    }
-    this->removeLeaf (delete_itr->first);
+    leaf_keys_.push_back (leaf_itr.getCurrentOctreeKey ());
+    leaf_vector_.push_back (&(leaf_itr.getLeafContainer ()));
   }
-  
+
+  //Run the compute function of each leaf, they are independent
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int> (leaf_vector_.size ()); ++i)
+    leaf_vector_[i]->computeData ();
+
+  computeNeighbors ();
+
   //Make sure our leaf vector is correctly sized
   assert (leaf_vector_.size () == this->getLeafCount ());
-  
- //  std::cout << "Time spent getting leaves ="<<t_getLeaf<<"\n";
- // std::cout << "Time spent computing data in leaves="<<t_compute<<"\n";
- // std::cout << "Time spent computing neighbors="<<t_neigh<<"\n";
-  
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -180,40 +149,99 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
-pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::computeNeighbors (OctreeKey &key_arg, LeafContainerT* leaf_container)
-{ 
-  
-  OctreeKey neighbor_key;
-  
-  for (int dx = -1; dx <= 1; ++dx)
+pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::computeNeighbors ()
+{
+  // Packed keys have 21 bits per coordinate, deeper octrees fall back to a
+  // hash map keyed by the full octree keys
+  packed_keys_ = max_key_.x < pcl::graph::MAX_VOXEL_KEY &&
+                 max_key_.y < pcl::graph::MAX_VOXEL_KEY &&
+                 max_key_.z < pcl::graph::MAX_VOXEL_KEY;
+
+  const int num_leaves = static_cast<int> (leaf_vector_.size ());
+  leaf_index_ = pcl::graph::VoxelHashTable (packed_keys_ ? num_leaves : 0);
+  LeafIndexMap leaf_index_map;
+  for (int i = 0; i < num_leaves; ++i)
   {
-    int x = dx + key_arg.x;
-    if (x < 0 || x > this->max_key_.x)
-      continue;
-    neighbor_key.x = static_cast<uint32_t> (x);
-    for (int dy = -1; dy <= 1; ++dy)
+    if (packed_keys_)
+      leaf_index_.insert (pcl::graph::packVoxelKey (leaf_keys_[i].x, leaf_keys_[i].y, leaf_keys_[i].z), i);
+    else
+      leaf_index_map[leaf_keys_[i]] = i;
+  }
+
+  // Two passes over the leaves: first count the neighbors to find the offsets
+  // into the flat neighbor array, then fill it in. The table lookups are
+  // read-only, so both passes run in parallel.
+  neighbor_offsets_.assign (num_leaves + 1, 0);
+  for (int pass = 0; pass < 2; ++pass)
+  {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < num_leaves; ++i)
     {
-      int y = dy + key_arg.y;
-      if (y < 0 || y > this->max_key_.y)
-        continue;
-      neighbor_key.y = static_cast<uint32_t> (y);
-      for (int dz = -1; dz <= 1; ++dz)
+      const OctreeKey& key = leaf_keys_[i];
+      size_t count = 0;
+      OctreeKey neighbor_key;
+      for (int dx = -1; dx <= 1; ++dx)
       {
-        int z = dz + key_arg.z;
-        if (z < 0 || z > this->max_key_.z)
+        int x = dx + key.x;
+        if (x < 0 || x > static_cast<int> (max_key_.x))
           continue;
-        neighbor_key.z = static_cast<uint32_t> (z);
-        LeafContainerT *neighbor = this->findLeaf (neighbor_key);
-        if (neighbor)
+        neighbor_key.x = static_cast<uint32_t> (x);
+        for (int dy = -1; dy <= 1; ++dy)
         {
-          leaf_container->addNeighbor (neighbor);
+          int y = dy + key.y;
+          if (y < 0 || y > static_cast<int> (max_key_.y))
+            continue;
+          neighbor_key.y = static_cast<uint32_t> (y);
+          for (int dz = -1; dz <= 1; ++dz)
+          {
+            int z = dz + key.z;
+            if (z < 0 || z > static_cast<int> (max_key_.z))
+              continue;
+            neighbor_key.z = static_cast<uint32_t> (z);
+            size_t neighbor;
+            bool found;
+            if (packed_keys_)
+            {
+              found = findLeafIndex (neighbor_key, neighbor);
+            }
+            else
+            {
+              typename LeafIndexMap::const_iterator f = leaf_index_map.find (neighbor_key);
+              found = f != leaf_index_map.end ();
+              if (found)
+                neighbor = f->second;
+            }
+            if (found)
+            {
+              if (pass == 1)
+                neighbors_[neighbor_offsets_[i] + count] = neighbor;
+              ++count;
+            }
+          }
         }
       }
+      if (pass == 0)
+        neighbor_offsets_[i + 1] = count;
+    }
+    if (pass == 0)
+    {
+      for (int i = 0; i < num_leaves; ++i)
+        neighbor_offsets_[i + 1] += neighbor_offsets_[i];
+      neighbors_.resize (neighbor_offsets_[num_leaves]);
     }
   }
-}
-
 
+  // Each container only stores its own neighbors, so they can be filled in
+  // parallel as well
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < num_leaves; ++i)
+    for (size_t j = neighbor_offsets_[i]; j < neighbor_offsets_[i + 1]; ++j)
+      leaf_vector_[i]->addNeighbor (leaf_vector_[neighbors_[j]]);
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafContainerT, typename BranchContainerT> LeafContainerT*
@@ -234,47 +262,75 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
 template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
 pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::computeVoxelAdjacencyGraph (VoxelAdjacencyList &voxel_adjacency_graph)
 {
-  //TODO Change this to use leaf centers, not centroids!
-  
-  voxel_adjacency_graph.clear ();
-  //Add a vertex for each voxel, store ids in map
-  std::map <LeafContainerT*, VoxelID> leaf_vertex_id_map;
-  for (typename OctreeAdjacencyT::LeafNodeIterator leaf_itr = this->leaf_begin () ; leaf_itr != this->leaf_end (); ++leaf_itr)
+  typedef std::pair<size_t, size_t> Edge;
+  const int num_leaves = static_cast<int> (leaf_vector_.size ());
+
+  // Every neighbor pair is stored twice in the neighbor array (and each leaf
+  // is its own neighbor), keep only the pairs where the neighbor comes later.
+  // The edges of each leaf are counted first to find where they go in the
+  // edge array, then the array is filled in parallel.
+  std::vector<size_t> edge_offsets (num_leaves + 1, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < num_leaves; ++i)
   {
-    OctreeKey leaf_key = leaf_itr.getCurrentOctreeKey ();
-    PointT centroid_point;
-    this->genLeafNodeCenterFromOctreeKey (leaf_key, centroid_point);
-    VoxelID node_id = add_vertex (voxel_adjacency_graph);
-    
-    voxel_adjacency_graph[node_id] = centroid_point;
-    LeafContainerT* leaf_container = &(leaf_itr.getLeafContainer ());
-    leaf_vertex_id_map[leaf_container] = node_id;
+    NeighborIterator neighbor_itr, neighbor_end;
+    boost::tie (neighbor_itr, neighbor_end) = getLeafNeighbors (i);
+    for ( ; neighbor_itr != neighbor_end; ++neighbor_itr)
+      if (*neighbor_itr > static_cast<size_t> (i))
+        ++edge_offsets[i + 1];
   }
-  
-  //Iterate through and add edges to adjacency graph
-  for ( typename std::vector<LeafContainerT*>::iterator leaf_itr = leaf_vector_.begin (); leaf_itr != leaf_vector_.end (); ++leaf_itr)
+  for (int i = 0; i < num_leaves; ++i)
+    edge_offsets[i + 1] += edge_offsets[i];
+  std::vector<Edge> edges (edge_offsets[num_leaves]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < num_leaves; ++i)
   {
-    typename LeafContainerT::iterator neighbor_itr = (*leaf_itr)->begin ();
-    typename LeafContainerT::iterator neighbor_end = (*leaf_itr)->end ();
-    LeafContainerT* neighbor_container;
-    VoxelID u = (leaf_vertex_id_map.find (*leaf_itr))->second;
-    PointT p_u = voxel_adjacency_graph[u];
+    size_t e = edge_offsets[i];
+    NeighborIterator neighbor_itr, neighbor_end;
+    boost::tie (neighbor_itr, neighbor_end) = getLeafNeighbors (i);
     for ( ; neighbor_itr != neighbor_end; ++neighbor_itr)
-    {
-      neighbor_container = *neighbor_itr;
-      EdgeID edge;
-      bool edge_added;
-      VoxelID v = (leaf_vertex_id_map.find (neighbor_container))->second;
-      boost::tie (edge, edge_added) = add_edge (u,v,voxel_adjacency_graph);
-      
-      PointT p_v = voxel_adjacency_graph[v];
-      float dist = (p_v.getVector3fMap () - p_u.getVector3fMap ()).norm ();
-      voxel_adjacency_graph[edge] = dist;
-      
-    }
-      
+      if (*neighbor_itr > static_cast<size_t> (i))
+        edges[e++] = Edge (i, *neighbor_itr);
+  }
+
+  // Leaf centers in structure-of-arrays layout so that the distance loop
+  // below vectorizes
+  std::vector<float> center_x (num_leaves), center_y (num_leaves), center_z (num_leaves);
+  for (int i = 0; i < num_leaves; ++i)
+  {
+    PointT center;
+    this->genLeafNodeCenterFromOctreeKey (leaf_keys_[i], center);
+    center_x[i] = center.x;
+    center_y[i] = center.y;
+    center_z[i] = center.z;
+  }
+  const int num_edges = static_cast<int> (edges.size ());
+  std::vector<float> weights (num_edges);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int e = 0; e < num_edges; ++e)
+  {
+    const float dx = center_x[edges[e].first] - center_x[edges[e].second];
+    const float dy = center_y[edges[e].first] - center_y[edges[e].second];
+    const float dz = center_z[edges[e].first] - center_z[edges[e].second];
+    weights[e] = std::sqrt (dx * dx + dy * dy + dz * dz);
+  }
+
+  // Vertex ids are leaf indices, so the graph is constructed from the edge
+  // list in one go
+  voxel_adjacency_graph = VoxelAdjacencyList (edges.begin (), edges.end (), weights.begin (), num_leaves, num_edges);
+  for (int i = 0; i < num_leaves; ++i)
+  {
+    PointT& center = voxel_adjacency_graph[i];
+    center.x = center_x[i];
+    center.y = center_y[i];
+    center.z = center_z[i];
   }
- 
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -287,7 +343,13 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   Eigen::Vector3f sensor(camera_pos.x,
                          camera_pos.y,
                          camera_pos.z);
-  
+
+  // Without a transform voxels are boxes in the point space, so the segment
+  // can be traversed exactly
+  if (!transform_func_)
+    return (traverseForOcclusion (key, sensor));
+
+  // Otherwise the segment is sampled with resolution-sized steps
   Eigen::Vector3f leaf_centroid(static_cast<float> ((static_cast<double> (key.x) + 0.5f) * this->resolution_ + this->min_x_),
                                 static_cast<float> ((static_cast<double> (key.y) + 0.5f) * this->resolution_ + this->min_y_), 
                                 static_cast<float> ((static_cast<double> (key.z) + 0.5f) * this->resolution_ + this->min_z_));
@@ -334,6 +396,84 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::testForOcclusion (const PointCloud& cloud_arg, std::vector<bool>& occluded, const PointXYZ &camera_pos)
+{
+  // std::vector<bool> packs bits, so can not be written from multiple threads
+  std::vector<unsigned char> flags (cloud_arg.size (), 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 256)
+#endif
+  for (int i = 0; i < static_cast<int> (cloud_arg.size ()); ++i)
+    if (pcl::isFinite (cloud_arg[i]))
+      flags[i] = testForOcclusion (cloud_arg[i], camera_pos);
+  occluded.assign (flags.begin (), flags.end ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> bool
+pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::traverseForOcclusion (const OctreeKey& key_arg, const Eigen::Vector3f& sensor) const
+{
+  // Amanatides-Woo voxel traversal. Everything is expressed in voxel units,
+  // the segment goes from the center of the start voxel (t = 0) to the
+  // sensor (t = 1).
+  const Eigen::Vector3d min (this->min_x_, this->min_y_, this->min_z_);
+  const int64_t max_key[3] = { max_key_.x, max_key_.y, max_key_.z };
+  int64_t key[3] = { key_arg.x, key_arg.y, key_arg.z };
+  const Eigen::Vector3d origin (key[0] + 0.5, key[1] + 0.5, key[2] + 0.5);
+  const Eigen::Vector3d direction = (sensor.cast<double> () - min) / resolution_ - origin;
+
+  int step[3];
+  double t_max[3];
+  double t_delta[3];
+  for (size_t i = 0; i < 3; ++i)
+  {
+    if (direction[i] > 0)
+    {
+      step[i] = 1;
+      t_max[i] = (key[i] + 1 - origin[i]) / direction[i];
+      t_delta[i] = 1.0 / direction[i];
+    }
+    else if (direction[i] < 0)
+    {
+      step[i] = -1;
+      t_max[i] = (key[i] - origin[i]) / direction[i];
+      t_delta[i] = -1.0 / direction[i];
+    }
+    else
+    {
+      step[i] = 0;
+      t_max[i] = std::numeric_limits<double>::infinity ();
+      t_delta[i] = std::numeric_limits<double>::infinity ();
+    }
+  }
+
+  while (true)
+  {
+    // Cross the closest voxel boundary
+    size_t axis = t_max[0] < t_max[1] ? 0 : 1;
+    if (t_max[2] < t_max[axis])
+      axis = 2;
+    // Reached the sensor without hitting an occupied voxel
+    if (t_max[axis] > 1.0)
+      return (false);
+    key[axis] += step[axis];
+    // Left the octree, nothing can be hit anymore
+    if (key[axis] < 0 || key[axis] > max_key[axis])
+      return (false);
+    t_max[axis] += t_delta[axis];
+    size_t leaf_index;
+    OctreeKey k;
+    k.x = static_cast<uint32_t> (key[0]);
+    k.y = static_cast<uint32_t> (key[1]);
+    k.z = static_cast<uint32_t> (key[2]);
+    // Deep octrees have no packed index, descend the tree instead
+    if (packed_keys_ ? findLeafIndex (k, leaf_index) : this->findLeaf (k) != 0)
+      return (true);
+  }
+}
+
 #define PCL_INSTANTIATE_OctreePointCloudAdjacency(T) template class PCL_EXPORTS pcl::octree::OctreePointCloudAdjacency<T>;
 
 #endif
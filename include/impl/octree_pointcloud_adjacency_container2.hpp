@@ -37,6 +37,10 @@
 #ifndef PCL_OCTREE_POINTCLOUD_ADJACENCY_CONTAINER_HPP_
 #define PCL_OCTREE_POINTCLOUD_ADJACENCY_CONTAINER_HPP_
 
+#include <boost/utility/enable_if.hpp>
+
+#include <pcl/point_types.h>
+
 namespace pcl
 {
 
@@ -169,10 +173,6 @@ namespace pcl
           return average_point_;
         }
 
-      private:
-
-        friend class OctreePointCloudAdjacencyContainer<PointT, AveragePoint<PointT> >;
-
         /** Add a new point. */
         void add (const PointT& pt)
         {
@@ -193,6 +193,8 @@ namespace pcl
           }
         }
 
+      private:
+
         detail::xyz_accumulator<PointT> xyz_;
         detail::normal_accumulator<PointT> normal_;
         detail::color_accumulator<PointT> color_;
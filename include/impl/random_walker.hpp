@@ -43,6 +43,8 @@
 
 #include <Eigen/Sparse>
 
+#include "graph/memory_usage.h"
+
 namespace pcl
 {
 
@@ -242,6 +244,21 @@ namespace pcl
               color_to_column_map[B_color_bimap.left.at (i)] = i;
           }
 
+          /** Add entries for the memory used by the solver (linear system,
+            * its solution, and auxiliary data) to a memory report. */
+          void
+          getMemoryUsage (pcl::graph::MemoryReport& report) const
+          {
+            using namespace pcl::graph::detail;
+            report.add ("vertex degrees", containerBytes (degree_storage_));
+            report.add ("seeds", containerBytes (seeds_) + containerBytes (colors_));
+            report.add ("L matrix", matrixBytes (L));
+            report.add ("B matrix", matrixBytes (B));
+            report.add ("X matrix", matrixBytes (X));
+            report.add ("L vertex bimap", containerBytes (L_vertex_bimap));
+            report.add ("B color bimap", containerBytes (B_color_bimap));
+          }
+
           template <typename T> static inline size_t
           insertInBimap (boost::bimap<size_t, T>& bimap, T value)
           {
@@ -42,6 +42,7 @@
 
 #include <pcl/search/kdtree.h>
 #include <pcl/kdtree/io.h>
+#include <pcl/common/common.h>
 
 #include "random_walker.h"
 #include "random_walker_segmentation.h"
@@ -54,6 +55,7 @@ template <typename PointT>
 pcl::segmentation::RandomWalkerSegmentation<PointT>::RandomWalkerSegmentation (bool store_potentials)
 : input_as_cloud_ (true)
 , graph_builder_ (0.006f)
+, roi_margin_ (-1.0f)
 , store_potentials_ (store_potentials)
 {
 }
@@ -111,9 +113,31 @@ pcl::segmentation::RandomWalkerSegmentation<PointT>::preComputeGraph ()
       PCL_THROW_EXCEPTION (ComputeFailedException,
                            "unable to pre-compute graph due to invalid input");
     }
+    // Restrict the graph to the points inside of the bounding box of the
+    // seeds (dilated by the margin), if requested.
+    pcl::IndicesPtr indices = indices_;
+    if (roi_margin_ >= 0.0f && seeds_ && seeds_->size ())
+    {
+      Eigen::Vector4f min, max;
+      pcl::getMinMax3D (*seeds_, min, max);
+      min.head<3> ().array () -= roi_margin_;
+      max.head<3> ().array () += roi_margin_;
+      indices.reset (new std::vector<int>);
+      indices->reserve (indices_->size ());
+      for (size_t i = 0; i < indices_->size (); ++i)
+      {
+        const PointT& p = input_->points[indices_->operator[] (i)];
+        // NaN points fail the comparisons and are excluded as well
+        if (p.x >= min[0] && p.y >= min[1] && p.z >= min[2] &&
+            p.x <= max[0] && p.y <= max[1] && p.z <= max[2])
+          indices->push_back (indices_->operator[] (i));
+      }
+    }
+
     graph_.reset (new Graph);
+    graph_components_.clear (); // the components refer to the old graph
     graph_builder_.setInputCloud (input_);
-    graph_builder_.setIndices (indices_);
+    graph_builder_.setIndices (indices);
     MEASURE_RUNTIME ("Building graph... ", graph_builder_.compute (*graph_));
     MEASURE_RUNTIME ("Computing normals... ", pcl::graph::computeNormalsAndCurvatures (*graph_));
     MEASURE_RUNTIME ("Computing curvature signs... ", pcl::graph::computeSignedCurvatures (*graph_));
@@ -162,19 +186,21 @@ pcl::segmentation::RandomWalkerSegmentation<PointT>::segment (std::vector<PointI
     // So that we have something to return if someone accidentally queries potentials
     potentials_ = Eigen::MatrixXf::Zero (0, 0);
 
+  typedef typename boost::property_map<Graph, boost::edge_weight_t>::type EdgeWeightMap;
+  typedef pcl::segmentation::detail::RandomWalker<Graph, EdgeWeightMap, VertexColorMap> Solver;
+
+  solver_memory_ = pcl::graph::MemoryReport ();
+
   for (size_t i = 0; i < graph_components_.size (); ++i)
   {
     Graph& g = graph_components_.at (i).get ();
-    bool success;
+    Solver solver (g, boost::get (boost::edge_weight, g), boost::get (boost::vertex_color, g));
+    bool success = solver.segment ();
     if (store_potentials_)
     {
       Eigen::MatrixXf p;
       ColorColumnMap colors_to_columns_map;
-      success = pcl::segmentation::randomWalker (g,
-                                                 boost::get (boost::edge_weight, g),
-                                                 boost::get (boost::vertex_color, g),
-                                                 p,
-                                                 colors_to_columns_map);
+      solver.getPotentials (p, colors_to_columns_map);
       for (ColorColumnMap::iterator iter = colors_to_columns_map.begin ();
            iter != colors_to_columns_map.end ();
            ++iter)
@@ -185,12 +211,10 @@ pcl::segmentation::RandomWalkerSegmentation<PointT>::segment (std::vector<PointI
           potentials_ (g.local_to_global (v), color - 1) = p (v, column);
       }
     }
-    else
-    {
-      success = pcl::segmentation::randomWalker (g,
-                                                 boost::get (boost::edge_weight, g),
-                                                 boost::get (boost::vertex_color, g));
-    }
+    pcl::graph::MemoryReport solver_memory;
+    solver.getMemoryUsage (solver_memory);
+    if (solver_memory.getTotalBytes () > solver_memory_.getTotalBytes ())
+      solver_memory_ = solver_memory;
     if (!success)
       pcl::console::print_error ("Random walker segmentation failed in component #%zu\n", i);
   }
@@ -201,6 +225,16 @@ pcl::segmentation::RandomWalkerSegmentation<PointT>::segment (std::vector<PointI
 
   if (input_as_cloud_)
   {
+    // Cluster sizes follow from the number of points per vertex, so the
+    // clusters can be allocated up front.
+    const pcl::graph::VertexToPointsMap& vertex_to_points_map = graph_builder_.getVertexToPointsMap ();
+    std::vector<size_t> cluster_sizes (clusters.size (), 0);
+    cluster_sizes.back () = input_->size () - vertex_to_points_map.indices.size ();
+    for (VertexId v = 0; v < boost::num_vertices (*graph_); ++v)
+      cluster_sizes[colors[v] == 0 ? clusters.size () - 1 : colors[v] - 1] += vertex_to_points_map.getNumberOfPoints (v);
+    for (size_t i = 0; i < clusters.size (); ++i)
+      clusters[i].indices.reserve (cluster_sizes[i]);
+
     const std::vector<VertexId>& point_to_vertex_map = graph_builder_.getPointToVertexMap ();
     for (size_t i = 0; i < input_->size (); ++i)
     {
@@ -235,6 +269,28 @@ pcl::segmentation::RandomWalkerSegmentation<PointT>::getPotentials () const
   return potentials_;
 }
 
+template <typename PointT> pcl::graph::MemoryReport
+pcl::segmentation::RandomWalkerSegmentation<PointT>::getMemoryUsage () const
+{
+  using namespace pcl::graph::detail;
+  pcl::graph::MemoryReport report;
+  if (graph_)
+  {
+    report = pcl::graph::computeMemoryUsage (*graph_);
+    report.add ("connected components", containerBytes (graph_components_));
+  }
+  if (input_as_cloud_)
+  {
+    report.add ("point to vertex map", containerBytes (graph_builder_.getPointToVertexMap ()));
+    report.add ("vertex to points map", containerBytes (graph_builder_.getVertexToPointsMap ().offsets) +
+                                        containerBytes (graph_builder_.getVertexToPointsMap ().indices));
+  }
+  report.add ("label bimap", containerBytes (label_color_bimap_));
+  report.add ("potentials", matrixBytes (potentials_));
+  report.add ("solver", solver_memory_);
+  return (report);
+}
+
 #define PCL_INSTANTIATE_RandomWalkerSegmentation(T) template class pcl::segmentation::RandomWalkerSegmentation<T>;
 
 #endif /* PCL_SEGMENTATION_IMPL_RANDOM_WALKER_SEGMENTATION_HPP */
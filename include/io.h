@@ -4,6 +4,8 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 
+#include <boost/graph/graph_traits.hpp>
+
 #include <Eigen/Sparse>
 
 template <typename PointT> bool
@@ -22,6 +24,22 @@ template <typename Graph> bool
 loadGraph (const std::string& filename,
            Graph& graph);
 
+/** Save a graph (points, edges with weights) together with a point to
+  * vertex map in a compact binary format. Unlike saveGraph(), the output is
+  * not meant to be human-readable, but can be loaded back quickly with
+  * loadGraphBinary(). */
+template <typename Graph> bool
+saveGraphBinary (const std::string& filename,
+                 const Graph& graph,
+                 const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& point_to_vertex_map);
+
+/** Load a graph saved with saveGraphBinary(). Fails if the file was written
+  * for a different point type. */
+template <typename Graph> bool
+loadGraphBinary (const std::string& filename,
+                 Graph& graph,
+                 std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& point_to_vertex_map);
+
 void
 saveSparseMatrix (const std::string& filename,
                   const Eigen::SparseMatrix<float>& M);
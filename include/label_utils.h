@@ -7,6 +7,8 @@
 #include <pcl/point_types.h>
 #include <pcl/common/io.h>
 
+#include "graph/graph_builder.h"
+
 namespace labels
 {
 
@@ -30,6 +32,37 @@ namespace labels
     return labeled;
   }
 
+  /** Same as above, but takes the mapping from graph vertices to points (as
+    * produced by GraphBuilder::getVertexToPointsMap()), which allows to
+    * assign labels to the points of different vertices in parallel. */
+  template <typename PointT, typename ColorMap> pcl::PointCloud<pcl::PointXYZL>::Ptr
+  createLabeledCloudFromColorMap (const typename pcl::PointCloud<PointT>& cloud,
+                                  const pcl::graph::VertexToPointsMap& vertex_to_points_map,
+                                  ColorMap color_map)
+  {
+    typedef typename boost::property_traits<ColorMap>::key_type VertexId;
+
+    pcl::PointCloud<pcl::PointXYZL>::Ptr labeled (new pcl::PointCloud<pcl::PointXYZL>);
+    pcl::copyPointCloud (cloud, *labeled);
+
+    for (size_t i = 0; i < labeled->size (); ++i)
+      labeled->at (i).label = 0;
+
+    const int num_vertices = static_cast<int> (vertex_to_points_map.offsets.size ()) - 1;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int v = 0; v < num_vertices; ++v)
+    {
+      const VertexId vertex = v;
+      const uint32_t label = color_map[vertex];
+      for (size_t i = vertex_to_points_map.offsets[v]; i < vertex_to_points_map.offsets[v + 1]; ++i)
+        labeled->at (vertex_to_points_map.indices[i]).label = label;
+    }
+
+    return labeled;
+  }
+
   /** Creates a new cloud of PointXYZL points with labels that match colors.
     *
     * The source cloud is copied over. NaN points get 0 label, finite points
@@ -0,0 +1,272 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Jeremie Papon
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_POINTCLOUD_ADJACENCY_H_
+#define PCL_OCTREE_POINTCLOUD_ADJACENCY_H_
+
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/graph/adjacency_list.hpp>
+
+#include <pcl/octree/octree_pointcloud.h>
+#include <pcl/octree/octree_pointcloud_adjacency_container.h>
+
+#include "graph/voxel_hash.h"
+
+namespace pcl
+{
+
+  namespace octree
+  {
+
+    /** \brief Octree class with leaf nodes that know their neighbors.
+      *
+      * This is the declaration of the adjacency octree from the pull request
+      * that fixed OctreeKey overflow (see impl/octree_pointcloud_adjacency3.hpp).
+      *
+      * The leaves are stored in a vector in the order in which the octree
+      * visits them. The neighbors of the leaves (26-neighborhood plus the
+      * leaf itself) are kept in a single flat array in compressed sparse row
+      * format and are referred to by their indices in the leaf vector. The
+      * leaf containers are also informed about their neighbors for
+      * compatibility with the code that iterates over container neighbors.
+      *
+      * \note The octree keys are packed and looked up in a flat hash table
+      * as long as the number of voxels along each axis is below
+      * pcl::graph::MAX_VOXEL_KEY. Larger octrees fall back to a (slower) hash
+      * map keyed by the full octree keys.
+      *
+      * \author Jeremie Papon (jpapon@gmail.com)
+      * \ingroup octree */
+    template <typename PointT,
+              typename LeafContainerT = OctreePointCloudAdjacencyContainer<PointT>,
+              typename BranchContainerT = OctreeContainerEmpty>
+    class OctreePointCloudAdjacency : public OctreePointCloud<PointT, LeafContainerT, BranchContainerT>
+    {
+
+      public:
+
+        typedef OctreeBase<LeafContainerT, BranchContainerT> OctreeBaseT;
+
+        typedef OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT> OctreeAdjacencyT;
+        typedef boost::shared_ptr<OctreeAdjacencyT> Ptr;
+        typedef boost::shared_ptr<const OctreeAdjacencyT> ConstPtr;
+
+        typedef OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeBaseT> OctreePointCloudT;
+        typedef typename OctreePointCloudT::LeafNode LeafNode;
+        typedef typename OctreePointCloudT::BranchNode BranchNode;
+
+        typedef pcl::PointCloud<PointT> PointCloud;
+
+        // BGL graph, vertex ids are the indices of the leaves in the leaf vector
+        typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, PointT, float> VoxelAdjacencyList;
+        typedef typename VoxelAdjacencyList::vertex_descriptor VoxelID;
+        typedef typename VoxelAdjacencyList::edge_descriptor EdgeID;
+
+        // Leaves have neighbors
+        typedef std::vector<LeafContainerT*> LeafVectorT;
+        typedef typename LeafVectorT::iterator iterator;
+        typedef typename LeafVectorT::const_iterator const_iterator;
+
+        /// Iterator over the indices of the neighbors of a leaf.
+        typedef std::vector<size_t>::const_iterator NeighborIterator;
+
+        inline iterator begin () { return (leaf_vector_.begin ()); }
+        inline iterator end ()   { return (leaf_vector_.end ()); }
+        inline LeafContainerT* at (size_t idx) { return (leaf_vector_.at (idx)); }
+
+        /** \brief Get the number of leaves. */
+        inline size_t size () const { return (leaf_vector_.size ()); }
+
+        /** \brief Constructor.
+          * \param[in] resolution_arg octree resolution at lowest octree level (voxel size) */
+        OctreePointCloudAdjacency (const double resolution_arg);
+
+        virtual
+        ~OctreePointCloudAdjacency ()
+        {
+        }
+
+        /** \brief Add points from the input cloud to the octree, compute leaf
+          * data and neighbors. */
+        void
+        addPointsFromInputCloud ();
+
+        /** \brief Get the leaf container that contains a given point.
+          * \return pointer to the container or null if there is no leaf */
+        LeafContainerT*
+        getLeafContainerAtPoint (const PointT& point_arg) const;
+
+        /** \brief Get the range of indices (in the leaf vector) of the
+          * neighbors of a given leaf. Every leaf is a neighbor of itself. */
+        inline std::pair<NeighborIterator, NeighborIterator>
+        getLeafNeighbors (size_t leaf_index) const
+        {
+          return (std::make_pair (neighbors_.begin () + neighbor_offsets_[leaf_index],
+                                  neighbors_.begin () + neighbor_offsets_[leaf_index + 1]));
+        }
+
+        /** \brief Compute an adjacency graph of the voxels.
+          *
+          * There is one vertex per leaf (with the same index as in the leaf
+          * vector and the leaf center as the vertex point), and one edge per
+          * pair of neighboring leaves, weighted with the distance between
+          * the centers. */
+        void
+        computeVoxelAdjacencyGraph (VoxelAdjacencyList &voxel_adjacency_graph);
+
+        /** \brief Set a function that transforms the points before they are
+          * inserted into the octree (e.g. to a perspective space). */
+        inline void
+        setTransformFunction (boost::function<void (PointT &p)> transform_func)
+        {
+          transform_func_ = transform_func;
+        }
+
+        /** \brief Test whether a given point is occluded, i.e. whether there
+          * are occupied voxels on the line segment between the point and the
+          * camera.
+          *
+          * The voxels on the segment are enumerated exactly and looked up in
+          * the leaf hash table, so the octree has to be filled with
+          * addPointsFromInputCloud() first. If a transform function is set,
+          * the segment is sampled with resolution-sized steps instead. */
+        bool
+        testForOcclusion (const PointT& point_arg, const PointXYZ &camera_pos = PointXYZ (0, 0, 0));
+
+        /** \brief Test a batch of points for occlusion (in parallel).
+          * \param[in] cloud_arg points to test
+          * \param[out] occluded occlusion flags, one per point (non-finite
+          * points are reported as not occluded)
+          * \param[in] camera_pos camera position */
+        void
+        testForOcclusion (const PointCloud& cloud_arg, std::vector<bool>& occluded, const PointXYZ &camera_pos = PointXYZ (0, 0, 0));
+
+      protected:
+
+        /** \brief Add a point with a given index to the octree. */
+        virtual void
+        addPointIdx (const int point_idx_arg);
+
+        /** \brief Build the leaf index hash table and compute the neighbors of
+          * all leaves. Expects leaf_vector_ and leaf_keys_ to be filled. */
+        void
+        computeNeighbors ();
+
+        /** \brief Find the index of the leaf with a given key.
+          * \note Only valid if the keys fit the packed format (packed_keys_).
+          * \return \c false if there is no such leaf */
+        inline bool
+        findLeafIndex (const OctreeKey& key, size_t& leaf_index) const
+        {
+          return (leaf_index_.find (pcl::graph::packVoxelKey (key.x, key.y, key.z), leaf_index));
+        }
+
+        /** \brief Walk through the voxels pierced by the segment between the
+          * center of a given voxel and the sensor (3D-DDA) and check whether
+          * any of them is occupied. The start voxel itself is not checked.
+          * Uses the packed leaf index if available, findLeaf() otherwise. */
+        bool
+        traverseForOcclusion (const OctreeKey& key_arg, const Eigen::Vector3f& sensor) const;
+
+        /** \brief Generate octree key for a (possibly transformed) point. */
+        virtual void
+        genOctreeKeyforPoint (const PointT& point_arg, OctreeKey &key_arg) const;
+
+        virtual bool
+        genOctreeKeyForDataT (const int& data_arg, OctreeKey & key_arg) const
+        {
+          return (false);
+        }
+
+      private:
+
+        /** \brief Hash function for OctreeKey (for the deep octree fallback). */
+        struct OctreeKeyHash
+        {
+          inline size_t
+          operator () (const OctreeKey& key) const
+          {
+            size_t seed = 0;
+            boost::hash_combine (seed, key.x);
+            boost::hash_combine (seed, key.y);
+            boost::hash_combine (seed, key.z);
+            return (seed);
+          }
+        };
+
+        typedef boost::unordered_map<OctreeKey, size_t, OctreeKeyHash> LeafIndexMap;
+
+        using OctreePointCloudT::input_;
+        using OctreePointCloudT::resolution_;
+        using OctreePointCloudT::min_x_;
+        using OctreePointCloudT::min_y_;
+        using OctreePointCloudT::min_z_;
+        using OctreePointCloudT::max_key_;
+
+        /// Leaf containers in the order of the octree leaf iterator.
+        LeafVectorT leaf_vector_;
+
+        /// Keys of the leaves, parallel to leaf_vector_.
+        std::vector<OctreeKey> leaf_keys_;
+
+        /// Whether the leaf keys fit in packed voxel keys (21 bits per axis).
+        bool packed_keys_;
+
+        /// Maps packed leaf keys to the indices in leaf_vector_ (only filled
+        /// if packed_keys_ is set).
+        pcl::graph::VoxelHashTable leaf_index_;
+
+        /// Neighbors of leaf i are neighbors_[neighbor_offsets_[i]] ...
+        /// neighbors_[neighbor_offsets_[i + 1] - 1].
+        std::vector<size_t> neighbor_offsets_;
+        std::vector<size_t> neighbors_;
+
+        boost::function<void (PointT &p)> transform_func_;
+
+    };
+
+  }
+
+}
+
+#include "impl/octree_pointcloud_adjacency3.hpp"
+
+#endif /* PCL_OCTREE_POINTCLOUD_ADJACENCY_H_ */
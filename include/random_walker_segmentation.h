@@ -49,6 +49,8 @@
 #include <pcl/search/search.h>
 
 #include "graph/point_cloud_graph.h"
+#include "graph/arena_allocator.h"
+#include "graph/memory_usage.h"
 #include "graph/voxel_grid_graph_builder.h"
 
 namespace pcl
@@ -125,11 +127,12 @@ namespace pcl
         typedef boost::subgraph
                 <pcl::graph::point_cloud_graph
                 <PointWithNormal,
-                 boost::vecS,
+                 pcl::graph::arena_vecS,
                  boost::undirectedS,
                  boost::property<boost::vertex_color_t, uint32_t>,
                  boost::property<boost::edge_weight_t, float,
-                 boost::property<boost::edge_index_t, int> > > >           Graph;
+                 boost::property<boost::edge_index_t, int> >,
+                 pcl::graph::arena_listS> >                                Graph;
         typedef typename boost::graph_traits<Graph>::vertex_descriptor     VertexId;
         typedef typename boost::graph_traits<Graph>::edge_descriptor       EdgeId;
         typedef typename boost::graph_traits<Graph>::vertex_iterator       VertexIterator;
@@ -187,6 +190,32 @@ namespace pcl
         setSeeds (const pcl::PointCloud<PointXYZL>::ConstPtr& seeds);
 
 
+        /** Restrict graph construction to a region of interest around the
+          * seeds.
+          *
+          * The region is the axis-aligned bounding box of the seeds, dilated
+          * by the given margin (in the units of the input cloud). Only the
+          * points inside of it become graph vertices, so the time needed to
+          * build the graph and run segmentation scales with the size of the
+          * region rather than with the size of the input cloud. The points
+          * outside of the region are put in the "unlabeled" cluster.
+          *
+          * A negative margin (default) disables the region of interest. It
+          * also has no effect if the input was given as a graph, or if the
+          * seeds were not set when the graph is built. */
+        inline void
+        setRegionOfInterestMargin (float margin)
+        {
+          roi_margin_ = margin;
+        }
+
+        inline float
+        getRegionOfInterestMargin () const
+        {
+          return (roi_margin_);
+        }
+
+
         /** Perform random walker segmentation.
           *
           * The clusters in the output vector will be in the order of inceasing
@@ -248,6 +277,18 @@ namespace pcl
         const Eigen::MatrixXf&
         getPotentials () const;
 
+
+        /** Get a report of the memory used by the segmentation object.
+          *
+          * The report covers the graph (including the subgraphs created for
+          * its connected components), the point to vertex map of the graph
+          * builder, the potentials matrix, and the random walker solver. The
+          * solver is run on each connected component in turn, so the entries
+          * for the solver correspond to the component that required the most
+          * memory during the last call to segment(). */
+        pcl::graph::MemoryReport
+        getMemoryUsage () const;
+
       private:
 
         typedef
@@ -266,6 +307,10 @@ namespace pcl
 
         pcl::graph::VoxelGridGraphBuilder<PointT, Graph> graph_builder_;
 
+        /// Margin around the bounding box of the seeds that defines the
+        /// region of interest (negative = no region of interest).
+        float roi_margin_;
+
         /// Maintains bi-directional mapping between seed labels and color
         /// identifiers (which are used in random walker segmentation).
         boost::bimap<uint32_t, uint32_t> label_color_bimap_;
@@ -273,6 +318,9 @@ namespace pcl
         bool store_potentials_;
         Eigen::MatrixXf potentials_;
 
+        /// Memory used by the solver on the largest connected component.
+        pcl::graph::MemoryReport solver_memory_;
+
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
     };
@@ -7,6 +7,7 @@
 #include <pcl/point_types.h>
 
 #include "graph/point_cloud_graph.h"
+#include "graph/arena_allocator.h"
 
 typedef pcl::PointXYZRGBA PointT;
 typedef pcl::PointXYZRGBNormal PointWithNormalT;
@@ -30,11 +31,12 @@ typedef
   boost::subgraph<
     pcl::graph::point_cloud_graph<
       PointWithNormalT
-    , boost::vecS
+    , pcl::graph::arena_vecS
     , boost::undirectedS
     , boost::property<boost::vertex_color_t, uint32_t>
     , boost::property<boost::edge_weight_t, float
     , boost::property<boost::edge_index_t, int>>
+    , pcl::graph::arena_listS
     >
   > Graph;
 
@@ -47,11 +49,12 @@ typedef
   boost::subgraph<
     pcl::graph::point_cloud_graph<
       PointT
-    , boost::vecS
+    , pcl::graph::arena_vecS
     , boost::undirectedS
     , boost::property<boost::vertex_color_t, uint32_t>
     , boost::property<boost::edge_weight_t, float
     , boost::property<boost::edge_index_t, int>>
+    , pcl::graph::arena_listS
     >
   > Graph;
 
@@ -0,0 +1,180 @@
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <pcl/console/parse.h>
+#include <pcl/console/print.h>
+#include <pcl/console/time.h>
+#include <pcl/common/common.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/io/pcd_io.h>
+
+#include "octree_pointcloud_adjacency3.h"
+
+typedef pcl::PointXYZ PointT;
+typedef pcl::PointCloud<PointT> PointCloudT;
+typedef pcl::octree::OctreePointCloudAdjacencyContainer<PointT> LeafContainerT;
+typedef pcl::octree::OctreePointCloudAdjacency<PointT> AdjacencyOctree;
+
+/** Reference adjacency octree which finds the neighbors of each leaf with 27
+  * findLeaf() descents and stores them in the leaf containers, the way
+  * OctreePointCloudAdjacency used to do it. */
+class FindLeafAdjacencyOctree : public pcl::octree::OctreePointCloud<PointT, LeafContainerT, pcl::octree::OctreeContainerEmpty>
+{
+
+  public:
+
+    typedef pcl::octree::OctreePointCloud<PointT, LeafContainerT, pcl::octree::OctreeContainerEmpty> OctreePointCloudT;
+
+    FindLeafAdjacencyOctree (const double resolution)
+    : OctreePointCloudT (resolution)
+    {
+    }
+
+    void
+    addPointsFromInputCloud ()
+    {
+      PointT min, max;
+      pcl::getMinMax3D (*this->input_, min, max);
+      this->defineBoundingBox (min.x, min.y, min.z, max.x, max.y, max.z);
+      OctreePointCloudT::addPointsFromInputCloud ();
+      for (LeafNodeIterator leaf_itr = this->leaf_begin (); leaf_itr != this->leaf_end (); ++leaf_itr)
+      {
+        const pcl::octree::OctreeKey key = leaf_itr.getCurrentOctreeKey ();
+        LeafContainerT* leaf = &(leaf_itr.getLeafContainer ());
+        leaf->computeData ();
+        pcl::octree::OctreeKey neighbor_key;
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+          int x = dx + key.x;
+          if (x < 0 || x > static_cast<int> (this->max_key_.x))
+            continue;
+          neighbor_key.x = static_cast<uint32_t> (x);
+          for (int dy = -1; dy <= 1; ++dy)
+          {
+            int y = dy + key.y;
+            if (y < 0 || y > static_cast<int> (this->max_key_.y))
+              continue;
+            neighbor_key.y = static_cast<uint32_t> (y);
+            for (int dz = -1; dz <= 1; ++dz)
+            {
+              int z = dz + key.z;
+              if (z < 0 || z > static_cast<int> (this->max_key_.z))
+                continue;
+              neighbor_key.z = static_cast<uint32_t> (z);
+              LeafContainerT* neighbor = this->findLeaf (neighbor_key);
+              if (neighbor)
+                leaf->addNeighbor (neighbor);
+            }
+          }
+        }
+      }
+    }
+
+  protected:
+
+    virtual void
+    addPointIdx (const int index)
+    {
+      const PointT& point = this->input_->points[index];
+      if (!pcl::isFinite (point))
+        return;
+      pcl::octree::OctreeKey key;
+      this->genOctreeKeyforPoint (point, key);
+      this->createLeaf (key)->addPoint (point);
+    }
+
+};
+
+/** Collect the sorted neighbor indices of every leaf, leaves are numbered
+  * by their position in the given vector. */
+std::vector<std::vector<size_t> >
+collectNeighbors (const std::vector<LeafContainerT*>& leaves)
+{
+  std::map<LeafContainerT*, size_t> indices;
+  for (size_t i = 0; i < leaves.size (); ++i)
+    indices[leaves[i]] = i;
+  std::vector<std::vector<size_t> > neighbors (leaves.size ());
+  for (size_t i = 0; i < leaves.size (); ++i)
+  {
+    for (LeafContainerT::iterator itr = leaves[i]->begin (); itr != leaves[i]->end (); ++itr)
+      neighbors[i].push_back (indices[*itr]);
+    std::sort (neighbors[i].begin (), neighbors[i].end ());
+  }
+  return (neighbors);
+}
+
+int
+main (int argc, char** argv)
+{
+  if (argc < 2 || pcl::console::find_switch (argc, argv, "--help"))
+  {
+    pcl::console::print_error ("Usage: %s <pcd-file>\n"
+                               "--resolution <float> (default: 0.006)\n"
+                               "--repeat <int> (default: 5)\n"
+                               , argv[0]);
+    pcl::console::print_info  ("Compares the neighbor computation of the adjacency octree with the\n"
+                               "reference implementation that descends the tree for every neighbor\n");
+    return (1);
+  }
+
+  float resolution = 0.006f;
+  int repeat = 5;
+  pcl::console::parse (argc, argv, "--resolution", resolution);
+  pcl::console::parse (argc, argv, "--repeat", repeat);
+  repeat = std::max (repeat, 1);
+
+  PointCloudT::Ptr cloud (new PointCloudT);
+  if (pcl::io::loadPCDFile (argv[1], *cloud) < 0)
+  {
+    pcl::console::print_error ("Failed to load \"%s\"\n", argv[1]);
+    return (2);
+  }
+
+  pcl::console::TicToc tt;
+  double time_flat = 0.0;
+  double time_find_leaf = 0.0;
+  bool same = true;
+  size_t num_leaves = 0;
+
+  for (int i = 0; i < repeat; ++i)
+  {
+    AdjacencyOctree flat (resolution);
+    flat.setInputCloud (cloud);
+    tt.tic ();
+    flat.addPointsFromInputCloud ();
+    time_flat += tt.toc ();
+
+    FindLeafAdjacencyOctree find_leaf (resolution);
+    find_leaf.setInputCloud (cloud);
+    tt.tic ();
+    find_leaf.addPointsFromInputCloud ();
+    time_find_leaf += tt.toc ();
+
+    // Both octrees have the same structure, so the leaves are visited in the
+    // same order and can be compared by position
+    if (i == 0)
+    {
+      std::vector<LeafContainerT*> flat_leaves (flat.begin (), flat.end ());
+      std::vector<LeafContainerT*> find_leaf_leaves;
+      for (FindLeafAdjacencyOctree::LeafNodeIterator itr = find_leaf.leaf_begin (); itr != find_leaf.leaf_end (); ++itr)
+        find_leaf_leaves.push_back (&(itr.getLeafContainer ()));
+      num_leaves = flat_leaves.size ();
+      same = collectNeighbors (flat_leaves) == collectNeighbors (find_leaf_leaves);
+    }
+  }
+
+  pcl::console::print_info ("%zu points, %zu leaves, average over %i runs\n", cloud->size (), num_leaves, repeat);
+  pcl::console::print_info ("Flat neighbors and hashed lookup: %g ms\n", time_flat / repeat);
+  pcl::console::print_info ("findLeaf() for every neighbor:    %g ms\n", time_find_leaf / repeat);
+
+  if (!same)
+  {
+    pcl::console::print_error ("Neighbor sets differ between the implementations\n");
+    return (3);
+  }
+
+  return (0);
+}
@@ -48,6 +48,7 @@ int main (int argc, char ** argv)
                                "--save-clusters\n"
                                "--potential\n"
                                "--fixed-colors\n"
+                               "--memory\n"
                                "%s\n"
                                "%s\n"
                                , argv[0]
@@ -81,6 +82,7 @@ int main (int argc, char ** argv)
   bool option_save = pcl::console::find_switch (argc, argv, "--save");
   bool option_save_clusters = pcl::console::find_switch (argc, argv, "--save-clusters");
   bool mode_no_gui = pcl::console::find_switch (argc, argv, "--tv-no-gui");
+  bool option_memory = pcl::console::find_switch (argc, argv, "--memory");
 
   if (mode_no_gui && !option_load_seeds)
   {
@@ -137,6 +139,9 @@ int main (int argc, char ** argv)
                             boost::num_vertices (graph),
                             boost::num_edges (graph));
 
+  if (option_memory)
+    wc->getMemoryUsage ().print ("Edge weight computer memory usage");
+
 
   /*********************************************************************
    *                          Visualize graph                          *
@@ -221,6 +226,9 @@ int main (int argc, char ** argv)
 
   rws.segment (clusters);
 
+  if (option_memory)
+    rws.getMemoryUsage ().print ("Random walker segmentation memory usage");
+
   viewer->add
   ( CreatePointCloudWithColorShufflingObject ("clusters", "c")
   . description                              ("Object clusters")
@@ -287,7 +295,7 @@ int main (int argc, char ** argv)
   {
     pcl::PointCloud<pcl::PointXYZL>::Ptr labeled;
     labeled = labels::createLabeledCloudFromColorMap (*cloud,
-                                                      gb->getPointToVertexMap (),
+                                                      gb->getVertexToPointsMap (),
                                                       boost::get (boost::vertex_color, graph));
     pcl::io::savePCDFile ("segmentation.pcd", *labeled);
   }
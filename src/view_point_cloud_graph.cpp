@@ -13,6 +13,7 @@
 #include "measure_runtime.h"
 #include "graph_visualizer.h"
 #include "factory/graph_factory.h"
+#include "graph/memory_usage.h"
 
 
 int main (int argc, char ** argv)
@@ -22,6 +23,7 @@ int main (int argc, char ** argv)
   if (argc < 2 || pcl::console::find_switch (argc, argv, "--help"))
   {
     pcl::console::print_error ("Usage: %s <pcd-file>\n"
+                               "--memory\n"
                                "%s\n"
                                , argv[0]
                                , g_factory.getUsage ().c_str ());
@@ -40,6 +42,8 @@ int main (int argc, char ** argv)
    *********************************************************************/
 
 
+  bool option_memory = pcl::console::find_switch (argc, argv, "--memory");
+
   auto g = g_factory.instantiate (cloud, argc, argv);
   auto& graph = g.get ();
 
@@ -49,6 +53,15 @@ int main (int argc, char ** argv)
                             boost::num_vertices (graph),
                             boost::num_edges (graph));
 
+  if (option_memory)
+  {
+    pcl::graph::computeMemoryUsage (*g_factory.getProducedGraph ()).print ("Graph memory usage");
+    if (g_factory.isLoadedFromCache ())
+      pcl::console::print_info ("Graph was loaded from the cache, edge weights were not computed\n");
+    else
+      g_factory.getEdgeWeightComputer ()->getMemoryUsage ().print ("Edge weight computer memory usage");
+  }
+
 
   /*********************************************************************
    *                          Visualize graph                          *